@@ -13,6 +13,8 @@
 #include <cmath>
 
 #include "apu.h"
+#include "bench.h"
+#include "savestate.h"
 
 /****** APU Constructor ******/
 APU::APU()
@@ -55,6 +57,9 @@ APU::APU()
 	//Initialize SDL audio
 	setup = false;
 
+	//Headless mode has no audio output
+	if(config::headless) { return; }
+
         SDL_InitSubSystem(SDL_INIT_AUDIO);
 
     	desired_spec.freq = 44100;
@@ -890,6 +895,85 @@ void APU::generate_channel_4_samples(s16* stream, int length)
 	}
 }
 
+/****** Save APU state ******/
+void APU::save_state(std::vector<u8> &state)
+{
+	//Each field is written on its own, so the state doesn't depend on how voice is laid out in memory
+	for(int x = 0; x < 4; x++)
+	{
+		savestate::write(state, channel[x].freq_dist);
+		savestate::write(state, channel[x].sample_length);
+		savestate::write(state, channel[x].frequency);
+		savestate::write(state, channel[x].raw_frequency);
+		savestate::write(state, channel[x].duration);
+		savestate::write(state, channel[x].volume);
+		savestate::write(state, channel[x].playing);
+
+		savestate::write(state, channel[x].duty_cycle_start);
+		savestate::write(state, channel[x].duty_cycle_end);
+
+		savestate::write(state, channel[x].envelope_direction);
+		savestate::write(state, channel[x].envelope_step);
+		savestate::write(state, channel[x].envelope_counter);
+
+		savestate::write(state, channel[x].sweep_direction);
+		savestate::write(state, channel[x].sweep_step);
+		savestate::write(state, channel[x].sweep_time);
+		savestate::write(state, channel[x].sweep_counter);
+		savestate::write(state, channel[x].sweep_on);
+
+		savestate::write(state, channel[x].wave_step);
+		savestate::write(state, channel[x].wave_shift);
+
+		savestate::write(state, channel[x].noise_dividing_ratio);
+		savestate::write(state, channel[x].noise_prescalar);
+		savestate::write(state, channel[x].noise_stages);
+		savestate::write(state, channel[x].noise_7_stage_lsfr);
+		savestate::write(state, channel[x].noise_15_stage_lsfr);
+	}
+}
+
+/****** Load APU state ******/
+bool APU::load_state(const std::vector<u8> &state, u32 &offset)
+{
+	bool result = true;
+
+	//Keep the audio callback from mixing half-loaded voices
+	if(setup) { SDL_LockAudio(); }
+
+	for(int x = 0; (x < 4) && (result); x++)
+	{
+		result = savestate::read(state, offset, channel[x].freq_dist)
+		&& savestate::read(state, offset, channel[x].sample_length)
+		&& savestate::read(state, offset, channel[x].frequency)
+		&& savestate::read(state, offset, channel[x].raw_frequency)
+		&& savestate::read(state, offset, channel[x].duration)
+		&& savestate::read(state, offset, channel[x].volume)
+		&& savestate::read(state, offset, channel[x].playing)
+		&& savestate::read(state, offset, channel[x].duty_cycle_start)
+		&& savestate::read(state, offset, channel[x].duty_cycle_end)
+		&& savestate::read(state, offset, channel[x].envelope_direction)
+		&& savestate::read(state, offset, channel[x].envelope_step)
+		&& savestate::read(state, offset, channel[x].envelope_counter)
+		&& savestate::read(state, offset, channel[x].sweep_direction)
+		&& savestate::read(state, offset, channel[x].sweep_step)
+		&& savestate::read(state, offset, channel[x].sweep_time)
+		&& savestate::read(state, offset, channel[x].sweep_counter)
+		&& savestate::read(state, offset, channel[x].sweep_on)
+		&& savestate::read(state, offset, channel[x].wave_step)
+		&& savestate::read(state, offset, channel[x].wave_shift)
+		&& savestate::read(state, offset, channel[x].noise_dividing_ratio)
+		&& savestate::read(state, offset, channel[x].noise_prescalar)
+		&& savestate::read(state, offset, channel[x].noise_stages)
+		&& savestate::read(state, offset, channel[x].noise_7_stage_lsfr)
+		&& savestate::read(state, offset, channel[x].noise_15_stage_lsfr);
+	}
+
+	if(setup) { SDL_UnlockAudio(); }
+
+	return result;
+}
+
 /****** Execute APU operations ******/
 void APU::step()
 {
@@ -936,6 +1020,8 @@ void APU::step()
 /****** SDL Audio Callback ******/ 
 void audio_callback(void* _apu, u8 *_stream, int _length)
 {
+	bench_scope timer(bench::APU_AUDIO);
+
 	s16* stream = (s16*) _stream;
 	int length = _length/2;
 
@@ -81,6 +81,10 @@ class APU
 	void play_channel_4();
 
 	void step();
+
+	//Save states
+	void save_state(std::vector<u8> &state);
+	bool load_state(const std::vector<u8> &state, u32 &offset);
 };
 
 /****** SDL Audio Callback ******/ 
@@ -0,0 +1,176 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : bench.cpp
+// Date : October 17, 2026
+// Description : Emulation benchmark
+//
+// Times the main emulator subsystems during a headless run
+// Reports frames/sec, cycles/sec and the time spent in each subsystem as JSON
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "bench.h"
+#include "config.h"
+
+namespace bench
+{
+	bool enabled = false;
+	u64 ticks[SECTION_COUNT];
+	u64 calls[SECTION_COUNT];
+	u32 depth[SECTION_COUNT];
+
+	//Start and end of the run, as timestamps and wall time
+	u64 start_ticks = 0;
+	u64 end_ticks = 0;
+	u64 start_wall = 0;
+	u64 end_wall = 0;
+
+	//Cost of taking the two timestamps around a timed call
+	u64 timer_overhead = 0;
+
+	//JSON names of each section
+	const char* section_names[SECTION_COUNT] = 
+	{
+		"cpu_exec_op",
+		"mmu_read_byte",
+		"mmu_write_byte",
+		"gpu_generate_scanline",
+		"gpu_generate_sprites",
+		"gpu_render_screen",
+		"apu_audio_callback"
+	};
+}
+
+/****** Wall time in nanoseconds ******/
+u64 bench::wall_time()
+{
+	#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (u64)((counter.QuadPart * 1000000000.0) / frequency.QuadPart);
+
+	#else
+	timespec current_time;
+	clock_gettime(CLOCK_MONOTONIC, &current_time);
+	return ((u64)current_time.tv_sec * 1000000000ULL) + current_time.tv_nsec;
+	#endif
+}
+
+/****** Start timing ******/
+void bench::start()
+{
+	for(int x = 0; x < SECTION_COUNT; x++) { ticks[x] = calls[x] = depth[x] = 0; }
+
+	//Measure the timer itself so it can be subtracted from very short calls like MMU reads
+	u64 overhead_total = 0;
+
+	for(int x = 0; x < 1000; x++)
+	{
+		u64 overhead_start = now();
+		overhead_total += now() - overhead_start;
+	}
+
+	timer_overhead = overhead_total / 1000;
+
+	enabled = true;
+	start_wall = wall_time();
+	start_ticks = now();
+}
+
+/****** Stop timing ******/
+void bench::stop()
+{
+	end_ticks = now();
+	end_wall = wall_time();
+	enabled = false;
+}
+
+/****** Write results as JSON - To a file if one is given, otherwise to stdout ******/
+bool bench::report(std::string rom_file, u32 frames, u64 cycles, u64 idle_loops, u64 idle_cycles, std::string filename)
+{
+	double wall_seconds = (end_wall - start_wall) / 1000000000.0;
+	if(wall_seconds <= 0) { wall_seconds = 0.000001; }
+
+	//Convert timestamps to seconds using the run itself for calibration
+	double seconds_per_tick = (end_ticks > start_ticks) ? (wall_seconds / (end_ticks - start_ticks)) : 0;
+
+	//Escape the ROM path for JSON
+	std::string rom_name = "";
+
+	for(u32 x = 0; x < rom_file.length(); x++)
+	{
+		if((rom_file[x] == '\\') || (rom_file[x] == '"')) { rom_name += '\\'; }
+		rom_name += rom_file[x];
+	}
+
+	std::stringstream json;
+	json << std::fixed << std::setprecision(6);
+
+	json << "{\n";
+	json << "\t\"rom\": \"" << rom_name << "\",\n";
+	json << "\t\"system\": \"" << ((config::gb_type == 2) ? "gbc" : "dmg") << "\",\n";
+	json << "\t\"jit\": " << (config::use_jit ? "true" : "false") << ",\n";
+	json << "\t\"frames\": " << frames << ",\n";
+	json << "\t\"cycles\": " << cycles << ",\n";
+	json << "\t\"wall_seconds\": " << wall_seconds << ",\n";
+	json << "\t\"frames_per_second\": " << (frames / wall_seconds) << ",\n";
+	json << "\t\"cycles_per_second\": " << (cycles / wall_seconds) << ",\n";
+
+	//Speed relative to real hardware - 4194304 cycles per second
+	json << "\t\"speed\": " << ((cycles / wall_seconds) / 4194304.0) << ",\n";
+
+	//Idle loops the CPU skipped ahead through, and the cycles skipped
+	json << "\t\"idle_loops\": " << idle_loops << ",\n";
+	json << "\t\"idle_cycles_skipped\": " << idle_cycles << ",\n";
+
+	json << "\t\"sections\": {\n";
+
+	for(int x = 0; x < SECTION_COUNT; x++)
+	{
+		//Remove timer overhead, then scale sampled sections back up to every call
+		u64 timed_calls = (calls[x] + sample_mask[x]) / (sample_mask[x] + 1);
+		u64 section_ticks = (ticks[x] > (timed_calls * timer_overhead)) ? (ticks[x] - (timed_calls * timer_overhead)) : 0;
+		double section_seconds = section_ticks * seconds_per_tick * (sample_mask[x] + 1);
+
+		json << "\t\t\"" << section_names[x] << "\": { ";
+		json << "\"seconds\": " << section_seconds << ", ";
+		json << "\"percent\": " << ((section_seconds * 100.0) / wall_seconds) << ", ";
+		json << "\"calls\": " << calls[x] << " }";
+		json << ((x + 1 < SECTION_COUNT) ? ",\n" : "\n");
+	}
+
+	json << "\t}\n";
+	json << "}\n";
+
+	if(filename == "")
+	{
+		std::cout<<json.str();
+		return true;
+	}
+
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+
+	if(!file.is_open())
+	{
+		std::cout<<"Bench : " << filename << " could not be opened. Check file path or permissions. \n";
+		return false;
+	}
+
+	file << json.str();
+	file.close();
+
+	std::cout<<"Bench : Results written to " << filename << "\n";
+	return true;
+}
@@ -0,0 +1,88 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : bench.h
+// Date : October 17, 2026
+// Description : Emulation benchmark
+//
+// Times the main emulator subsystems during a headless run
+// Reports frames/sec, cycles/sec and the time spent in each subsystem as JSON
+
+#ifndef GB_BENCH
+#define GB_BENCH
+
+#include <string>
+
+#include "common.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GBE_BENCH_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define GBE_BENCH_TSC
+#endif
+
+namespace bench
+{
+	//Timed subsystems
+	enum section { CPU_EXEC, MMU_READ, MMU_WRITE, GPU_SCANLINE, GPU_SPRITES, GPU_RENDER, APU_AUDIO, SECTION_COUNT };
+
+	extern bool enabled;
+	extern u64 ticks[SECTION_COUNT];
+	extern u64 calls[SECTION_COUNT];
+	extern u32 depth[SECTION_COUNT];
+
+	//Sections called for nearly every instruction are only timed once every 64 calls to keep overhead down
+	//Their totals are scaled back up in the report
+	const u32 sample_mask[SECTION_COUNT] = { 63, 63, 63, 0, 0, 0, 0 };
+
+	//Emulated cycles between audio callbacks - 2048 samples at 44100Hz
+	const u32 AUDIO_CYCLES = 194783;
+
+	//Wall time in nanoseconds
+	u64 wall_time();
+
+	//Raw timestamp - CPU timestamp counter where available, calibrated against wall time
+	inline u64 now()
+	{
+		#ifdef GBE_BENCH_TSC
+		return __rdtsc();
+		#else
+		return wall_time();
+		#endif
+	}
+
+	void start();
+	void stop();
+	bool report(std::string rom_file, u32 frames, u64 cycles, u64 idle_loops, u64 idle_cycles, std::string filename);
+}
+
+/****** Times one call of a subsystem - Nested and recursive calls count once ******/
+struct bench_scope
+{
+	u8 section;
+	bool timed;
+	u64 start_time;
+
+	bench_scope(u8 timed_section) : section(timed_section), timed(false), start_time(0)
+	{
+		if((bench::enabled) && (bench::depth[section]++ == 0) && ((bench::calls[section]++ & bench::sample_mask[section]) == 0))
+		{
+			timed = true;
+			start_time = bench::now();
+		}
+	}
+
+	~bench_scope()
+	{
+		if(bench::enabled)
+		{
+			bench::depth[section]--;
+			if(timed) { bench::ticks[section] += bench::now() - start_time; }
+		}
+	}
+};
+
+#endif // GB_BENCH
@@ -6,6 +6,8 @@ g++ -c -O3 -funroll-loops mbc3.cpp
 g++ -c -O3 -funroll-loops mbc5.cpp
 g++ -c -O3 -funroll-loops mmu.cpp
 g++ -c -O3 -funroll-loops z80.cpp
+g++ -c -O3 -funroll-loops z80_cache.cpp
+g++ -c -O3 -funroll-loops z80_jit.cpp
 g++ -c -O3 -funroll-loops gamepad.cpp -lmingw32 -lSDLmain -lSDL
 g++ -c -O3 -funroll-loops filter.cpp -lmingw32 -lSDLmain -lSDL
 g++ -c -O3 -funroll-loops gpu.cpp -lmingw32 -lSDLmain -lSDL
@@ -13,5 +15,15 @@ g++ -c -O3 -funroll-loops apu.cpp -lmingw32 -lSDLmain -lSDL
 g++ -c -O3 -funroll-loops hotkeys.cpp -lmingw32 -lSDLmain -lSDL
 g++ -c -O3 -funroll-loops opengl.cpp -lmingw32 -lSDLmain -lSDL -lopengl32
 g++ -c -O3 -funroll-loops custom_gfx.cpp -lmingw32 -lSDLmain -lSDL
+g++ -c -O3 -funroll-loops bench.cpp
+g++ -c -O3 -funroll-loops savestate.cpp
+g++ -c -O3 -funroll-loops rewind.cpp
+g++ -c -O3 -funroll-loops tile.cpp
+g++ -c -O3 -funroll-loops present.cpp
+g++ -c -O3 -funroll-loops render_worker.cpp
+g++ -c -O3 -funroll-loops scheduler.cpp
+g++ -c -O3 -funroll-loops timer.cpp
+g++ -c -O3 -funroll-loops rom_file.cpp
+g++ -c -O3 -funroll-loops inflate.cpp
 g++ -c -O3 -funroll-loops source.cpp -lmingw32 -lSDLmain -lSDL
-g++ -o gbe.exe config.o hash.o mbc1.o mbc2.o mbc3.o mbc5.o mmu.o z80.o gamepad.o filter.o gpu.o apu.o hotkeys.o opengl.o custom_gfx.o source.o -lmingw32 -lSDLmain -lSDL -lopengl32
\ No newline at end of file
+g++ -o gbe.exe config.o hash.o mbc1.o mbc2.o mbc3.o mbc5.o mmu.o z80.o z80_cache.o z80_jit.o gamepad.o filter.o gpu.o apu.o hotkeys.o opengl.o custom_gfx.o bench.o savestate.o rewind.o tile.o present.o render_worker.o scheduler.o timer.o rom_file.o inflate.o source.o -lmingw32 -lSDLmain -lSDL -lopengl32
\ No newline at end of file
@@ -54,6 +54,20 @@ else
 	exit
 fi
 
+if g++ -c -O3 -funroll-loops z80_cache.cpp; then
+	echo -e "Compiling Z80 Block Cache...		\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Z80 Block Cache...		\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops z80_jit.cpp; then
+	echo -e "Compiling Z80 JIT...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Z80 JIT...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
 if g++ -c -O3 -funroll-loops gamepad.cpp -lSDL; then
 	echo -e "Compiling Game Pad...			\E[32m[DONE]\E[37m"
 else
@@ -104,6 +118,76 @@ else
 fi
 
 
+if g++ -c -O3 -funroll-loops bench.cpp; then
+	echo -e "Compiling Bench...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Bench...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops savestate.cpp; then
+	echo -e "Compiling Save States...		\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Save States...		\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops rewind.cpp; then
+	echo -e "Compiling Rewind...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Rewind...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops tile.cpp; then
+	echo -e "Compiling Tile Decoder...		\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Tile Decoder...		\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops present.cpp; then
+	echo -e "Compiling Presenter...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Presenter...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops render_worker.cpp; then
+	echo -e "Compiling Render Worker...		\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Render Worker...		\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops scheduler.cpp; then
+	echo -e "Compiling Scheduler...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Scheduler...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops timer.cpp; then
+	echo -e "Compiling Timer...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Timer...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops rom_file.cpp; then
+	echo -e "Compiling ROM File...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling ROM File...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
+if g++ -c -O3 -funroll-loops inflate.cpp; then
+	echo -e "Compiling Inflate...			\E[32m[DONE]\E[37m"
+else
+	echo -e "Compiling Inflate...			\E[31m[ERROR]\E[37m"
+	exit
+fi
+
 if g++ -c -O3 -funroll-loops source.cpp -lSDL; then
 	echo -e "Compiling Main...			\E[32m[DONE]\E[37m"
 else
@@ -111,7 +195,7 @@ else
 	exit
 fi
 
-if g++ -o gbe config.o hash.o mbc1.o mbc2.o mbc3.o mbc5.o mmu.o z80.o gamepad.o filter.o gpu.o apu.o hotkeys.o opengl.o custom_gfx.o source.o -lSDL -lGL; then
+if g++ -o gbe config.o hash.o mbc1.o mbc2.o mbc3.o mbc5.o mmu.o z80.o z80_cache.o z80_jit.o gamepad.o filter.o gpu.o apu.o hotkeys.o opengl.o custom_gfx.o bench.o savestate.o rewind.o tile.o present.o render_worker.o scheduler.o timer.o rom_file.o inflate.o source.o -lSDL -lGL; then
 	echo -e "Linking Project...			\E[32m[DONE]\E[37m"
 else
 	echo -e "Linking Project...			\E[31m[ERROR]\E[37m"
@@ -45,6 +45,40 @@ namespace config
 	//Temporarily disable framelimit
 	bool turbo = false;
 
+	//Frames drawn while the framelimit is off - 1 of every frame_skip frames, or none in logic-only mode
+	u32 frame_skip = 1;
+	bool logic_only = false;
+
+	//Use x86-64 recompiler
+	bool use_jit = false;
+
+	//Run without video or audio, stop after a number of frames or cycles (0 = no limit)
+	bool headless = false;
+	u32 max_frames = 0;
+	u64 max_cycles = 0;
+	std::string dump_frame_file = "";
+
+	//Run the emulation benchmark, optionally writing the results to a file
+	bool bench = false;
+	std::string bench_file = "";
+
+	//Start from a save state, and save the state on exit
+	std::string load_state_file = "";
+	std::string save_state_file = "";
+
+	//Rewind buffer size in MB (0 = off), and frames between snapshots
+	u32 rewind_budget = 0;
+	u32 rewind_interval = 2;
+
+	//Draw frames as 8-bit palette indices, converted to ARGB once per frame
+	bool indexed_framebuffer = false;
+
+	//Scale and blit frames on a separate presenter thread
+	bool use_presenter = true;
+
+	//Draw scanlines on a separate render worker thread
+	bool use_render_worker = false;
+
 	//Mouse click
 	bool mouse_click = false;
 
@@ -140,6 +174,94 @@ bool parse_cli_args()
 
 			//Force GBC emulation
 			else if(config::cli_args[x] == "--force-gbc") { config::gb_type = 2; }
+
+			//Use x86-64 recompiler
+			else if(config::cli_args[x] == "--jit") { config::use_jit = true; }
+
+			//Run without video or audio, no framelimit
+			else if(config::cli_args[x] == "--headless") { config::headless = true; config::turbo = true; }
+
+			//Stop after a number of frames
+			else if((config::cli_args[x] == "--frames") && (x + 1 < config::cli_args.size()))
+			{
+				std::stringstream value_stream(config::cli_args[++x]);
+				if(!(value_stream >> config::max_frames))
+				{
+					std::cout<<"Error : Invalid frame count - " << config::cli_args[x] << "\n";
+					return false;
+				}
+			}
+
+			//Stop after a number of emulated cycles
+			else if((config::cli_args[x] == "--cycles") && (x + 1 < config::cli_args.size()))
+			{
+				std::stringstream value_stream(config::cli_args[++x]);
+				if(!(value_stream >> config::max_cycles))
+				{
+					std::cout<<"Error : Invalid cycle count - " << config::cli_args[x] << "\n";
+					return false;
+				}
+			}
+
+			//Run the emulation benchmark - Always headless
+			else if(config::cli_args[x] == "--bench") { config::bench = true; config::headless = true; config::turbo = true; }
+
+			//Write benchmark results to a file instead of stdout
+			else if((config::cli_args[x] == "--bench_file") && (x + 1 < config::cli_args.size())) { config::bench_file = config::cli_args[++x]; }
+
+			//Save the final frame to a BMP file
+			else if((config::cli_args[x] == "--dump_frame") && (x + 1 < config::cli_args.size())) { config::dump_frame_file = config::cli_args[++x]; }
+
+			//Start from a save state
+			else if((config::cli_args[x] == "--load_state") && (x + 1 < config::cli_args.size())) { config::load_state_file = config::cli_args[++x]; }
+
+			//Save the state on exit
+			else if((config::cli_args[x] == "--save_state") && (x + 1 < config::cli_args.size())) { config::save_state_file = config::cli_args[++x]; }
+
+			//Scale and blit frames on the emulation thread
+			else if(config::cli_args[x] == "--single_thread") { config::use_presenter = false; }
+
+			//Draw scanlines on a render worker thread
+			else if(config::cli_args[x] == "--render_thread") { config::use_render_worker = true; }
+
+			//Draw 1 of every n frames while the framelimit is off
+			else if((config::cli_args[x] == "--frame_skip") && (x + 1 < config::cli_args.size()))
+			{
+				std::stringstream value_stream(config::cli_args[++x]);
+				if(!(value_stream >> config::frame_skip) || (config::frame_skip == 0))
+				{
+					std::cout<<"Error : Invalid frame skip - " << config::cli_args[x] << "\n";
+					return false;
+				}
+			}
+
+			//Draw nothing while the framelimit is off
+			else if(config::cli_args[x] == "--logic_only") { config::logic_only = true; }
+
+			//Use the 8-bit indexed framebuffer
+			else if(config::cli_args[x] == "--indexed") { config::indexed_framebuffer = true; }
+
+			//Set rewind buffer size
+			else if((config::cli_args[x] == "--rewind") && (x + 1 < config::cli_args.size()))
+			{
+				std::stringstream value_stream(config::cli_args[++x]);
+				if(!(value_stream >> config::rewind_budget))
+				{
+					std::cout<<"Error : Invalid rewind buffer size - " << config::cli_args[x] << "\n";
+					return false;
+				}
+			}
+
+			//Set frames between rewind snapshots
+			else if((config::cli_args[x] == "--rewind_interval") && (x + 1 < config::cli_args.size()))
+			{
+				std::stringstream value_stream(config::cli_args[++x]);
+				if(!(value_stream >> config::rewind_interval) || (config::rewind_interval == 0))
+				{
+					std::cout<<"Error : Invalid rewind interval - " << config::cli_args[x] << "\n";
+					return false;
+				}
+			}
 			
 			else 
 			{
@@ -148,6 +270,18 @@ bool parse_cli_args()
 			}
 		}
 
+		//Headless mode never opens a window, so don't try to use OpenGL or scaling filters
+		if(config::headless)
+		{
+			config::use_opengl = false;
+			config::use_scaling = false;
+			config::scaling_mode = 0;
+			config::scaling_factor = 1;
+		}
+
+		//Benchmarks need an end point, default to 1 minute of emulated time
+		if((config::bench) && (config::max_frames == 0) && (config::max_cycles == 0)) { config::max_frames = 3600; }
+
 		return true;
 	}
 }
@@ -322,5 +456,17 @@ bool parse_config_file()
 		}
 	}
 
+	//Check for rewind buffer size
+	if(config::ini_parameters.size() >= 26)
+	{
+		config::rewind_budget = config::ini_parameters[25];
+	}
+
+	//Check for frames between rewind snapshots
+	if(config::ini_parameters.size() >= 27)
+	{
+		if(config::ini_parameters[26] != 0) { config::rewind_interval = config::ini_parameters[26]; }
+	}
+
 	return true;
 }
\ No newline at end of file
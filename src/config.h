@@ -37,6 +37,22 @@ namespace config
 	extern std::vector <u32> ini_parameters;
 	extern u32 flags;
 	extern bool turbo;
+	extern u32 frame_skip;
+	extern bool logic_only;
+	extern bool use_jit;
+	extern bool headless;
+	extern u32 max_frames;
+	extern u64 max_cycles;
+	extern std::string dump_frame_file;
+	extern bool bench;
+	extern std::string bench_file;
+	extern std::string load_state_file;
+	extern std::string save_state_file;
+	extern u32 rewind_budget;
+	extern u32 rewind_interval;
+	extern bool indexed_framebuffer;
+	extern bool use_presenter;
+	extern bool use_render_worker;
 	extern bool mouse_click;
 	extern u32 mouse_x;
 	extern u32 mouse_y;
@@ -282,10 +282,6 @@ void GPU::dump_bg_window()
 /****** Loads sprites from files ******/
 void GPU::load_sprites()
 {
-	u8 high_byte, low_byte = 0;
-	u8 high_bit, low_bit = 0;
-	u8 final_byte = 0;
-
 	u8 sprite_height = 0;
 
 	SDL_Surface* custom_sprite = NULL;
@@ -376,31 +372,8 @@ void GPU::load_sprites()
 		{
 			sprites[x].custom_data_loaded = false;
 
-			//Read Sprite Options
-			u8 pal = sprites[x].options & 0x10 ? 1 : 0;
-			sprite_tile_addr = (sprites[x].tile_number * 16) + 0x8000;
-			u8 pixel_counter = 0;
-
-			//Cycles through tile
-			for(int y = 0; y < sprite_height; y++)
-			{
-				//Grab High and Low Bytes for Tile
-				high_byte = mem_link->memory_map[sprite_tile_addr];
-				low_byte = mem_link->memory_map[sprite_tile_addr+1];
-
-				//Cycle through High and Low bytes
-				for(int z = 7; z >= 0; z--)
-				{
-					high_bit = (high_byte >> z) & 0x01;
-					low_bit = (low_byte >> z) & 0x01;
-					final_byte = high_bit + (low_bit * 2);
-
-					sprites[x].raw_data[pixel_counter] = final_byte;
-					pixel_counter++;
-				}
-
-				sprite_tile_addr += 2;
-			}
+			tile::decode(&mem_link->video_ram[sprites[x].tile_number * 16], sprite_height, sprites[x].raw_data,
+			(sprites[x].options & 0x20), (sprites[x].options & 0x40));
 		}
 	}
 }
@@ -492,6 +465,7 @@ void GPU::load_bg_tileset_1()
 
 	//Clear tileset updates
 	tile_set_1_updates.clear();
+	memset(tile_set_1_listed, 0, sizeof(tile_set_1_listed));
 }
 
 /****** Loads BG tiles from files ******/
@@ -581,4 +555,5 @@ void GPU::load_bg_tileset_0()
 
 	//Clear tileset updates
 	tile_set_0_updates.clear();
+	memset(tile_set_0_listed, 0, sizeof(tile_set_0_listed));
 }
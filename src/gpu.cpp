@@ -11,6 +11,8 @@
 
 #include "gpu.h"
 #include "filter.h"
+#include "bench.h"
+#include "savestate.h"
 
 /****** GPU Constructor ******/
 GPU::GPU() 
@@ -24,18 +26,53 @@ GPU::GPU()
 	temp_screen = NULL;
 	mem_link = NULL;
 	lcd_enabled = false;
+	frame_count = 0;
+	skip_frame = false;
+
+	presenter = NULL;
+	presenter_running = false;
+	frame_ready = NULL;
+	screen_ready = NULL;
+	back_buffer = 0;
+	front_buffer = 1;
+	ready_buffer = 2;
+	screen_reset_request = false;
+	screenshot_request = false;
+	for(int x = 0; x < 3; x++) { frame_surfaces[x] = NULL; }
+
+	render_worker = NULL;
+	worker_wakeup = NULL;
+	line_queued = false;
+	worker_sleeping = false;
+	worker_running = false;
+	memset(&line_state, 0, sizeof(line_state));
+
+	tile::init();
 
 	if(config::use_scaling)
 	{	
-		temp_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, (256 * config::scaling_factor), (144 * config::scaling_factor), 32, 0, 0, 0, 0);
+		temp_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, (160 * config::scaling_factor), (144 * config::scaling_factor), 32, 0, 0, 0, 0);
 	}
 
-	src_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, 256, 144, 32, 0, 0, 0, 0);
+	src_screen = SDL_CreateRGBSurface(SDL_SWSURFACE, 160, 144, 32, 0, 0, 0, 0);
 
 	//Initialize a bunch of data to 0 - Let's avoid segfaults...
 	memset(scanline_pixel_data, 0xFFFFFFFF, sizeof(scanline_pixel_data));
 	memset(final_pixel_data, 0xFFFFFFFF, sizeof(final_pixel_data));
 
+	draw_frame = 0;
+	frame_converted = true;
+
+	for(int x = 0; x < 2; x++)
+	{
+		memset(indexed_frames[x].pixel_data, INDEXED_BLANK, sizeof(indexed_frames[x].pixel_data));
+		memset(indexed_frames[x].line_palette, 0, sizeof(indexed_frames[x].line_palette));
+		memset(indexed_frames[x].palettes, 0xFF, sizeof(indexed_frames[x].palettes));
+		indexed_frames[x].palette_count = 0;
+	}
+
+	begin_frame();
+
 	sprite_hash_list.push_back(" ");
 
 	for(int x = 0; x < 40; x++)
@@ -45,6 +82,12 @@ GPU::GPU()
 		sprites[x].custom_data_loaded = false;
 	}
 
+	memset(line_sprite_count, 0, sizeof(line_sprite_count));
+	memset(bg_win_raw_data, 0, sizeof(bg_win_raw_data));
+	memset(bg_priority, 0, sizeof(bg_priority));
+	memset(tile_set_0_listed, 0, sizeof(tile_set_0_listed));
+	memset(tile_set_1_listed, 0, sizeof(tile_set_1_listed));
+
 	for(int x = 0; x < 0x100; x++)
 	{
 		memset(tile_set_1[x].raw_data, 0, sizeof(tile_set_1[x].raw_data));
@@ -72,7 +115,11 @@ GPU::GPU()
 }
 
 /****** GPU Deconstructor ******/
-GPU::~GPU() { }
+GPU::~GPU() 
+{
+	stop_render_worker();
+	stop_presenter();
+}
 
 /****** Flip pixel data horizontally - For sprites only ******/
 void GPU::horizontal_flip(u16 width, u16 height, u32 pixel_data[])
@@ -133,95 +180,59 @@ void GPU::scanline_compare()
 	else { mem_link->memory_map[REG_STAT] &= ~0x4; }
 }
 
-/****** Updates a specific tile - DMG Mode ******/
-void GPU::update_bg_tile()
+/****** Decodes one tile from VRAM into 2-bit color indices ******/
+void GPU::decode_tile(u8 bank, u16 tile_number, u8 pixel_data[])
 {
-	u8 high_byte, low_byte = 0;
-	u8 high_bit, low_bit = 0;
-	u8 final_byte = 0;
-
-	u16 tile_addr = 0;
-	u8 tile_number = 0;
-	u8 tile_row = 0;
-
-	u16 pixel_counter = 0;
+	tile::decode(&mem_link->video_ram[(bank * 0x2000) + (tile_number * 16)], 8, pixel_data);
+}
 
-	//Update tiles for every address that was written to since last update
-	for(int x = 0; x < mem_link->gpu_update_addr.size(); x++)
+/****** Updates tiles marked in the VRAM dirty bitmap - DMG Mode ******/
+void GPU::update_bg_tile()
+{
+	for(int x = 0; x < 12; x++)
 	{
-		//Update a tile row for Tile Set #1
-		if((mem_link->gpu_update_addr[x] >= 0x8000) && (mem_link->gpu_update_addr[x] <= 0x8FFF))
-		{
-			tile_number = (mem_link->gpu_update_addr[x] - 0x8000)/16;
-			tile_addr = 0x8000 + (tile_number * 16);
-			tile_row = (mem_link->gpu_update_addr[x] - tile_addr)/2;
-			tile_addr += (tile_row * 2);
-			pixel_counter = (tile_row * 8);
-			
-			//Grab High and Low Bytes for Background Tile
-			high_byte = mem_link->read_byte(tile_addr);
-			low_byte = mem_link->read_byte(tile_addr+1);
-
-			//Cycle through High and Low bytes
-			for(int y = 7; y >= 0; y--)
-			{
-				high_bit = (high_byte >> y) & 0x01;
-				low_bit = (low_byte >> y) & 0x01;
-				final_byte = high_bit + (low_bit * 2);
-
-				tile_set_1[tile_number].raw_data[pixel_counter] = final_byte;
-				pixel_counter++;
-			}
-
-			//Add tile to the list of updated tiles to see if custom tiles can be loaded
-			bool add_tile = true;
+		u32 dirty_tiles = mem_link->gpu_dirty_tiles[0][x];
+		if(dirty_tiles == 0) { continue; }
+		mem_link->gpu_dirty_tiles[0][x] = 0;
 
-			for(int y = 0; y < tile_set_1_updates.size(); y++)
-			{
-				if(tile_set_1_updates[y] == tile_number) { add_tile = false; }
-			}
-		
-			if(add_tile) { tile_set_1_updates.push_back(tile_number); }
-		}
-
-		//Update a tile row for Tile Set #1
-		if((mem_link->gpu_update_addr[x] >= 0x8800) && (mem_link->gpu_update_addr[x] <= 0x97FF))
+		for(int y = 0; y < 32; y++)
 		{
-			tile_number = (mem_link->gpu_update_addr[x] - 0x8800)/16;
-			tile_addr = 0x8800 + (tile_number * 16);
-			tile_row = (mem_link->gpu_update_addr[x] - tile_addr)/2;
-			tile_addr += (tile_row * 2);
-			pixel_counter = (tile_row * 8);
-			
-			//Grab High and Low Bytes for Background Tile
-			high_byte = mem_link->read_byte(tile_addr);
-			low_byte = mem_link->read_byte(tile_addr+1);
+			if((dirty_tiles & (1 << y)) == 0) { continue; }
+			u16 tile_number = (x * 32) + y;
 
-			//Cycle through High and Low bytes
-			for(int y = 7; y >= 0; y--)
+			//Tile Set #1 - 0x8000 to 0x8FFF
+			if(tile_number < 0x100)
 			{
-				high_bit = (high_byte >> y) & 0x01;
-				low_bit = (low_byte >> y) & 0x01;
-				final_byte = high_bit + (low_bit * 2);
+				decode_tile(0, tile_number, tile_set_1[tile_number].raw_data);
 
-				tile_set_0[tile_number].raw_data[pixel_counter] = final_byte;
-				pixel_counter++;
+				//Add tile to the list of updated tiles to see if custom tiles can be loaded
+				if((config::load_sprites) && (!tile_set_1_listed[tile_number]))
+				{
+					tile_set_1_listed[tile_number] = true;
+					tile_set_1_updates.push_back(tile_number);
+				}
 			}
 
-			//Add tile to the list of updated tiles to see if custom tiles can be loaded
-			bool add_tile = true;
-
-			for(int y = 0; y < tile_set_0_updates.size(); y++)
+			//Tile Set #0 - 0x8800 to 0x97FF
+			if(tile_number >= 0x80)
 			{
-				if(tile_set_0_updates[y] == tile_number) { add_tile = false; }
+				u8 set_number = tile_number - 0x80;
+				decode_tile(0, tile_number, tile_set_0[set_number].raw_data);
+
+				if((config::load_sprites) && (!tile_set_0_listed[set_number]))
+				{
+					tile_set_0_listed[set_number] = true;
+					tile_set_0_updates.push_back(set_number);
+				}
 			}
-		
-			if(add_tile) { tile_set_0_updates.push_back(tile_number); }
 		}
+	}
 
-		//When a new background palette is used, update the tile checklist to include all tiles
-		//Don't repeat once a new background palette has been established!
-		if((mem_link->gpu_update_addr[x] == REG_BGP) && (last_bgp != mem_link->memory_map[REG_BGP]))
+	//When a new background palette is used, update the tile checklist to include all tiles
+	//Don't repeat once a new background palette has been established!
+	if((mem_link->gpu_update_bgp) && (last_bgp != mem_link->memory_map[REG_BGP]))
+	{
+		if(config::load_sprites)
 		{
 			tile_set_0_updates.clear();
 			tile_set_1_updates.clear();
@@ -229,400 +240,298 @@ void GPU::update_bg_tile()
 			{ 
 				tile_set_0_updates.push_back(y);
 				tile_set_1_updates.push_back(y); 
+				tile_set_0_listed[y] = tile_set_1_listed[y] = true;
 			}
-
-			last_bgp = mem_link->memory_map[REG_BGP];
 		}
+
+		last_bgp = mem_link->memory_map[REG_BGP];
 	}
 
-	mem_link->gpu_update_addr.clear();
+	mem_link->gpu_update_bgp = false;
 }
 
-/****** Updates a specific tile - GBC Mode ******/
+/****** Updates tiles marked in the VRAM dirty bitmap - GBC Mode ******/
 void GPU::update_gbc_bg_tile()
 {
-	u8 high_byte, low_byte = 0;
-	u8 high_bit, low_bit = 0;
-	u8 final_byte = 0;
-
-	u16 tile_addr = 0;
-	u8 tile_number = 0;
-	u8 tile_row = 0;
-
-	u16 pixel_counter = 0;
-
-	//Update tiles for every address that was written to since last update
-	for(int x = 0; x < mem_link->gpu_update_addr.size(); x++)
+	for(int bank = 0; bank < 2; bank++)
 	{
-		//Update a tile row for Tile Set #1
-		if((mem_link->gpu_update_addr[x] >= 0x8000) && (mem_link->gpu_update_addr[x] <= 0x8FFF))
+		for(int x = 0; x < 12; x++)
 		{
-			tile_number = (mem_link->gpu_update_addr[x] - 0x8000)/16;
-			tile_addr = 0x8000 + (tile_number * 16);
-			tile_row = (mem_link->gpu_update_addr[x] - tile_addr)/2;
-			tile_addr += (tile_row * 2);
-			pixel_counter = (tile_row * 8);
-			
-			//Grab High and Low Bytes for Background Tile
-			high_byte = mem_link->read_byte(tile_addr);
-			low_byte = mem_link->read_byte(tile_addr+1);
+			u32 dirty_tiles = mem_link->gpu_dirty_tiles[bank][x];
+			if(dirty_tiles == 0) { continue; }
+			mem_link->gpu_dirty_tiles[bank][x] = 0;
 
-			//Cycle through High and Low bytes
-			for(int y = 7; y >= 0; y--)
+			for(int y = 0; y < 32; y++)
 			{
-				high_bit = (high_byte >> y) & 0x01;
-				low_bit = (low_byte >> y) & 0x01;
-				final_byte = high_bit + (low_bit * 2);
+				if((dirty_tiles & (1 << y)) == 0) { continue; }
+				u16 tile_number = (x * 32) + y;
 
-				gbc_tile_set_1[tile_number][mem_link->vram_bank].raw_data[pixel_counter] = final_byte;
-				pixel_counter++;
-			}
-		}
+				//Tile Set #1 - 0x8000 to 0x8FFF
+				if(tile_number < 0x100) { decode_tile(bank, tile_number, gbc_tile_set_1[tile_number][bank].raw_data); }
 
-		//Update a tile row for Tile Set #1
-		if((mem_link->gpu_update_addr[x] >= 0x8800) && (mem_link->gpu_update_addr[x] <= 0x97FF))
-		{
-			tile_number = (mem_link->gpu_update_addr[x] - 0x8800)/16;
-			tile_addr = 0x8800 + (tile_number * 16);
-			tile_row = (mem_link->gpu_update_addr[x] - tile_addr)/2;
-			tile_addr += (tile_row * 2);
-			pixel_counter = (tile_row * 8);
-			
-			//Grab High and Low Bytes for Background Tile
-			high_byte = mem_link->read_byte(tile_addr);
-			low_byte = mem_link->read_byte(tile_addr+1);
-
-			//Cycle through High and Low bytes
-			for(int y = 7; y >= 0; y--)
-			{
-				high_bit = (high_byte >> y) & 0x01;
-				low_bit = (low_byte >> y) & 0x01;
-				final_byte = high_bit + (low_bit * 2);
-
-				gbc_tile_set_0[tile_number][mem_link->vram_bank].raw_data[pixel_counter] = final_byte;
-				pixel_counter++;
+				//Tile Set #0 - 0x8800 to 0x97FF
+				if(tile_number >= 0x80) { decode_tile(bank, tile_number, gbc_tile_set_0[tile_number - 0x80][bank].raw_data); }
 			}
 		}
 	}
 
-	mem_link->gpu_update_addr.clear();
+	mem_link->gpu_update_bgp = false;
 }
 
-/****** Prepares scanline for rendering - Pulls data from BG, Window, and Sprites ******/
-void GPU::generate_scanline()
+/****** Decodes any tiles changed since the last update ******/
+void GPU::update_tiles()
 {
-	u8 current_scanline = mem_link->memory_map[REG_LY] + mem_link->memory_map[REG_SY];
-	u8 current_bgp = mem_link->memory_map[REG_BGP];
-	u8 current_pixel = 0x100 - mem_link->memory_map[REG_SX];
+	if(mem_link->gpu_update_bg_tile)
+	{
+		finish_scanline();
 
-	u32 bg_win_raw_data[0x100];
-	u32 bg_priority[0x100];
+		if(config::gb_type != 2) { update_bg_tile(); }
+		else { update_gbc_bg_tile(); }
+		mem_link->gpu_update_bg_tile = false;
+	}
+}
 
-	u16 map_addr = 0;
-	u16 tile_set_addr = 0;
-	u8 map_entry = 0;
-	u8 tile_pixel = 0;
+/****** Draws one row of a BG or window tile to the scanline, starting at tile_x - Returns false once the right edge is reached ******/
+bool GPU::draw_tile_row(u8 map_entry, u8 map_attribute, u8 tile_line, u8 tile_x, u8 &current_pixel, bool highlight_tile)
+{
+	u8 lcdc = line_state.lcdc;
+	u8* tile_pixels = NULL;
+	u8 flipped_row[8];
+	u32* custom_pixels = NULL;
+	u32* colors = dmg_bg_colors;
+	u8 color_step = 1;
+	u8 priority = 0;
+
+	//Indexed framebuffer - DMG pixels store their shade, GBC pixels their palette and color
+	static const u8 gbc_shades[4] = { 0, 1, 2, 3 };
+	u8* shades = bgp;
+	u8 palette_index = 0;
+
+	//Choose from the correct Tile Set
+	if(lcdc & 0x10)
+	{
+		tile_pixels = &tile_set_1[map_entry].raw_data[tile_line * 8];
+		if((config::load_sprites) && (tile_set_1[map_entry].custom_data_loaded)) { custom_pixels = &tile_set_1[map_entry].custom_data[tile_line * 8]; }
+	}
 
-	//Determine Tile Map Address
-	if(mem_link->memory_map[REG_LCDC] & 0x08) { map_addr = 0x9C00; }
-	else { map_addr = 0x9800; }
+	else
+	{
+		map_entry = signed_tile(map_entry);
+		tile_pixels = &tile_set_0[map_entry].raw_data[tile_line * 8];
+		if((config::load_sprites) && (tile_set_0[map_entry].custom_data_loaded)) { custom_pixels = &tile_set_0[map_entry].custom_data[tile_line * 8]; }
+	}
 
-	//Determine Background/Window Palette - From lightest to darkest
-	bgp[0] = current_bgp & 0x3;
-	bgp[1] = (current_bgp >> 2) & 0x3;
-	bgp[2] = (current_bgp >> 4) & 0x3;
-	bgp[3] = (current_bgp >> 6) & 0x3;
+	//GBC Mode - Map attributes pick the tile bank, palette, flipping and priority
+	if((config::gb_type == 2) && (custom_pixels == NULL))
+	{
+		u8 bg_tile_bank = (map_attribute & 0x8) ? 1 : 0;
 
-	//Determine which tiles we should generate to get the scanline data - integer division ftw :p
-	u16 tile_lower_range = (current_scanline/8) * 32;
-	u16 tile_upper_range = tile_lower_range + 32;
+		//Vertical flip - Read the mirrored row
+		if(map_attribute & 0x40) { tile_line = 7 - tile_line; }
 
-	//Render Background Pixel Data
-	if(mem_link->memory_map[REG_LCDC] & 0x01)
-	{
-		//Determine which line of the tiles we should generate pixels for this scanline
-		u8 tile_line = current_scanline % 8;
+		if(lcdc & 0x10) { tile_pixels = &gbc_tile_set_1[map_entry][bg_tile_bank].raw_data[tile_line * 8]; }
+		else { tile_pixels = &gbc_tile_set_0[map_entry][bg_tile_bank].raw_data[tile_line * 8]; }
 
-		//Generate background pixel data for selected tiles
-		for(int x = tile_lower_range; x < tile_upper_range; x++)
+		//Horizontal flip - Read the row backwards
+		if(map_attribute & 0x20)
 		{
-			bool highlight_tile = false;
-			u8 bg_palette = 0;
-			u8 bg_tile_bank = 0;
-			u8 bg_map_attribute = 0;
+			for(int x = 0; x < 8; x++) { flipped_row[x] = tile_pixels[7 - x]; }
+			tile_pixels = flipped_row;
+		}
 
-			//Check if tile can be highlighted - For BG tile dumping
-			if(config::dump_sprites)
-			{
-				u32 line_bound = mem_link->memory_map[REG_LY];
-				u32 left_bound = current_pixel;
-				u32 right_bound = current_pixel + 8;
+		//GBC colors are stored color-major, so colors of one palette are 8 entries apart
+		colors = &background_colors_final[0][map_attribute & 0x7];
+		color_step = 8;
+		priority = (map_attribute & 0x80) ? 1 : 0;
 
-				if(((config::mouse_x/config::scaling_factor) > left_bound) && ((config::mouse_x/config::scaling_factor) < right_bound)
-				&& ((config::mouse_y/config::scaling_factor) == line_bound)) { highlight_tile = true; }
-			}
+		shades = (u8*)gbc_shades;
+		palette_index = (map_attribute & 0x7) << 2;
+	}
 
-			for(int y = (tile_line * 8); y < ((tile_line * 8) + 8); y++)
-			{
-				map_entry = mem_link->read_byte(map_addr + x);
+	for(int x = tile_x; x < 8; x++)
+	{
+		u8 tile_pixel = tile_pixels[x];
 
-				//Choose from the correct Tile Set
-				if(mem_link->memory_map[REG_LCDC] & 0x10) 
-				{
-					tile_pixel = tile_set_1[map_entry].raw_data[y];
-					if(highlight_tile) { dump_tile_1 = map_entry; dump_mode = 1; }
-				}
-				else 
-				{ 
-					map_entry = signed_tile(map_entry); 
-					tile_pixel = tile_set_0[map_entry].raw_data[y];
-					if(highlight_tile) { dump_tile_0 = map_entry; dump_mode = 0; } 
-				}
+		bg_win_raw_data[current_pixel] = tile_pixel;
+		bg_priority[current_pixel] = priority;
 
-				bg_win_raw_data[current_pixel] = tile_pixel;
+		if(indexed_frame) { scanline_index_data[current_pixel] = palette_index | shades[tile_pixel]; }
+		else if(custom_pixels != NULL) { scanline_pixel_data[current_pixel] = custom_pixels[x]; }
+		else { scanline_pixel_data[current_pixel] = colors[tile_pixel * color_step]; }
 
-				if((config::load_sprites) && (mem_link->memory_map[REG_LCDC] & 0x10) && (tile_set_1[map_entry].custom_data_loaded)) 
-				{ 
-					scanline_pixel_data[current_pixel] = tile_set_1[map_entry].custom_data[y];
-				}
+		//Highlight tiles on mouseover - For BG tile dumping
+		if(highlight_tile) { scanline_pixel_data[current_pixel] += 0x00700000; }
 
-				else if((config::load_sprites) && ((mem_link->memory_map[REG_LCDC] & 0x10) == 0) && (tile_set_0[map_entry].custom_data_loaded))
-				{
-					scanline_pixel_data[current_pixel] = tile_set_0[map_entry].custom_data[y];
-				}
+		if(++current_pixel == 160) { return false; }
+	}
 
-				else
-				{
-					//Output Scanline data to RGBA - DMG Mode
-					if(config::gb_type != 2)
-					{
-						//Output Scanline data to RGBA
-						switch(bgp[tile_pixel])
-						{
-							case 0: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[0];
-								break;
+	return true;
+}
 
-							case 1: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[1];
-								break;
+/****** Prepares scanline for rendering - Hands it to the render worker when it's running ******/
+void GPU::generate_scanline()
+{
+	if(skip_frame) { return; }
 
-							case 2: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[2];
-								break;
+	//Only one line is in flight, so the worker has to be done with the last one before its inputs change
+	finish_scanline();
+	capture_scanline();
 
-							case 3: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[3];
-								break;
-						}
-					}
+	if(render_worker != NULL) { queue_scanline(); }
+	else { render_scanline(); }
+}
 
-					//Output Scanline data to RGBA - GBC Mode
-					else
-					{	
-						if((y % 8) == 0)
-						{
-							u8 old_vram_bank = mem_link->vram_bank;
+/****** Copy the LCD registers and tile map rows the current scanline is drawn from ******/
+void GPU::capture_scanline()
+{
+	line_state.ly = mem_link->memory_map[REG_LY];
+	line_state.lcdc = mem_link->memory_map[REG_LCDC];
+	line_state.scx = mem_link->memory_map[REG_SX];
+	line_state.scy = mem_link->memory_map[REG_SY];
+	line_state.wx = mem_link->memory_map[REG_WX];
+	line_state.wy = mem_link->memory_map[REG_WY];
+	line_state.bgp = mem_link->memory_map[REG_BGP];
+
+	//Background map row
+	u16 map_addr = (line_state.lcdc & 0x08) ? 0x9C00 : 0x9800;
+	u8 current_scanline = line_state.ly + line_state.scy;
+	u16 map_offset = (map_addr - 0x8000) + ((current_scanline/8) * 32);
+
+	memcpy(line_state.bg_map, &mem_link->video_ram[map_offset], 32);
+	memcpy(line_state.bg_attributes, &mem_link->video_ram[0x2000 + map_offset], 32);
+
+	//Window map row
+	if((line_state.ly - line_state.wy >= 0) && (line_state.lcdc & 0x20))
+	{
+		map_addr = (line_state.lcdc & 0x40) ? 0x9C00 : 0x9800;
+		map_offset = (map_addr - 0x8000) + (((line_state.ly - line_state.wy)/8) * 32);
+
+		memcpy(line_state.win_map, &mem_link->video_ram[map_offset], 32);
+		memcpy(line_state.win_attributes, &mem_link->video_ram[0x2000 + map_offset], 32);
+	}
+}
 
-							//Always read CHR data from Bank 0
-							mem_link->vram_bank = 0;
-							map_entry = mem_link->read_byte(map_addr + x);
+/****** Draws the captured scanline - Pulls data from BG, Window, and Sprites ******/
+void GPU::render_scanline()
+{
+	bench_scope timer(bench::GPU_SCANLINE);
 
-							//Read BG Map attributes from Bank 1
-							mem_link->vram_bank = 1;
-							bg_map_attribute = mem_link->read_byte(map_addr + x);
-							bg_palette = bg_map_attribute & 0x7;
-							bg_tile_bank = (bg_map_attribute & 0x8) ? 1 : 0;
+	u8 current_scanline = line_state.ly + line_state.scy;
+	u8 current_bgp = line_state.bgp;
+	u8 current_pixel = 0;
 
-							if(mem_link->memory_map[REG_LCDC] & 0x10) { bg_tile = gbc_tile_set_1[map_entry][bg_tile_bank]; }
-							else { map_entry = signed_tile(map_entry); bg_tile = gbc_tile_set_0[map_entry][bg_tile_bank]; }
+	u8 map_entry = 0;
+	u8 lcdc = line_state.lcdc;
 
-							if(bg_map_attribute & 0x20) { horizontal_flip(8, 8, bg_tile.raw_data); }
-							if(bg_map_attribute & 0x40) { vertical_flip(8, 8, bg_tile.raw_data); }
-						
-							mem_link->vram_bank = old_vram_bank;
-						}
+	//Determine Background/Window Palette - From lightest to darkest
+	bgp[0] = current_bgp & 0x3;
+	bgp[1] = (current_bgp >> 2) & 0x3;
+	bgp[2] = (current_bgp >> 4) & 0x3;
+	bgp[3] = (current_bgp >> 6) & 0x3;
 
-						bg_priority[current_pixel] = (bg_map_attribute & 0x80) ? 1 : 0;
-						bg_win_raw_data[current_pixel] = bg_tile.raw_data[y];
-						scanline_pixel_data[current_pixel] = background_colors_final[bg_tile.raw_data[y]][bg_palette];
-					}	
-				}
-				
-				//Highlight tiles on mouseover - For BG tile dumping
-				if(config::dump_sprites)
-				{
-					if((mem_link->memory_map[REG_LCDC] & 0x10) && (map_entry == dump_tile_1)) { scanline_pixel_data[current_pixel] += 0x00700000; }
-					else if(((mem_link->memory_map[REG_LCDC] & 0x10) == 0) && (map_entry == dump_tile_0)) { scanline_pixel_data[current_pixel] += 0x00700000; }
-				}
+	for(int x = 0; x < 4; x++) { dmg_bg_colors[x] = config::DMG_PAL_BG[bgp[x]]; }
 
-				current_pixel++;
-			}
-		}
-	}
+	if((indexed_frame) && (palette_dirty)) { latch_palette(); }
 
-	//Render Window Pixel Data
-	if((mem_link->memory_map[REG_LY] - mem_link->memory_map[REG_WY] >= 0) && (mem_link->memory_map[REG_LCDC] & 0x20))
-	{
-		//Determine Tile Map Address
-		if(mem_link->memory_map[REG_LCDC] & 0x40) { map_addr = 0x9C00; }
-		else { map_addr = 0x9800; }
+	//Mouse position on the screen - For BG tile dumping
+	int mouse_x = config::mouse_x / config::scaling_factor;
+	int mouse_y = config::mouse_y / config::scaling_factor;
 
-		current_pixel = mem_link->memory_map[REG_WX] - 7;
-		u8 window_line = (mem_link->memory_map[REG_LY] - mem_link->memory_map[REG_WY]) % 8;
+	//Render Background Pixel Data
+	if(lcdc & 0x01)
+	{
+		//Determine which line of the tiles we should generate pixels for this scanline
+		u8 tile_line = current_scanline % 8;
 
-		//Determine which tiles we should generate to get the scanline data
-		tile_lower_range = ((mem_link->memory_map[REG_LY] - mem_link->memory_map[REG_WY])/8) * 32;
-		tile_upper_range = tile_lower_range + 32;
+		//Start with the tile under the left edge of the screen - The map wraps around horizontally
+		u8 map_x = line_state.scx / 8;
+		u8 tile_x = line_state.scx % 8;
+		bool drawing = true;
 
-		//Generate window pixel data for selected tiles
-		for(int x = tile_lower_range; x < tile_upper_range; x++)
+		//Generate background pixel data for selected tiles - Stop at the right edge of the scanline
+		while(drawing)
 		{
 			bool highlight_tile = false;
-			u8 bg_tile_bank = 0;
-			u8 bg_palette = 0;
-			u8 bg_map_attribute = 0;
+			map_entry = line_state.bg_map[map_x];
 
 			//Check if tile can be highlighted - For BG tile dumping
 			if(config::dump_sprites)
 			{
-				u32 line_bound = mem_link->memory_map[REG_LY];
-				u32 left_bound = current_pixel;
-				u32 right_bound = current_pixel + 8;
+				int left_bound = current_pixel - tile_x;
+				int right_bound = left_bound + 8;
 
-				if(((config::mouse_x/config::scaling_factor) > left_bound) && ((config::mouse_x/config::scaling_factor) < right_bound)
-				&& ((config::mouse_y/config::scaling_factor) == line_bound)) { highlight_tile = true; }
-			}
-
-			for(int y = (window_line * 8); y < ((window_line * 8) + 8); y++)
-			{
-				map_entry = mem_link->read_byte(map_addr + x);
-
-				//Choose from the correct Tile Set
-				if(mem_link->memory_map[REG_LCDC] & 0x10) 
+				if((mouse_x > left_bound) && (mouse_x < right_bound) && (mouse_y == line_state.ly))
 				{
-					tile_pixel = tile_set_1[map_entry].raw_data[y];
-					if(highlight_tile) { dump_tile_win = map_entry; dump_mode = 2; }
-				}
-				else 
-				{ 
-					map_entry = signed_tile(map_entry); 
-					tile_pixel = tile_set_0[map_entry].raw_data[y];
-					if(highlight_tile) { dump_tile_win = map_entry; dump_mode = 3; } 
+					if(lcdc & 0x10) { dump_tile_1 = map_entry; dump_mode = 1; }
+					else { dump_tile_0 = signed_tile(map_entry); dump_mode = 0; }
 				}
 
-				bg_win_raw_data[current_pixel] = tile_pixel;
-
-				if((config::load_sprites) && (mem_link->memory_map[REG_LCDC] & 0x10) && (tile_set_1[map_entry].custom_data_loaded)) 
-				{ 
-					scanline_pixel_data[current_pixel] = tile_set_1[map_entry].custom_data[y];
-				}
-
-				else if((config::load_sprites) && ((mem_link->memory_map[REG_LCDC] & 0x10) == 0) && (tile_set_0[map_entry].custom_data_loaded))
-				{
-					scanline_pixel_data[current_pixel] = tile_set_0[map_entry].custom_data[y];
-				}
-
-				else
-				{
-					//Output Scanline data to RGBA - DMG Mode
-					if(config::gb_type != 2)
-					{
-						//Output Scanline data to RGBA
-						switch(bgp[tile_pixel])
-						{
-							case 0: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[0];
-								break;
-
-							case 1: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[1];
-								break;
-
-							case 2: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[2];
-								break;
+				if(lcdc & 0x10) { highlight_tile = (map_entry == dump_tile_1); }
+				else { highlight_tile = (signed_tile(map_entry) == dump_tile_0); }
+			}
 
-							case 3: 
-								scanline_pixel_data[current_pixel] = config::DMG_PAL_BG[3];
-								break;
-						}
-					}
+			drawing = draw_tile_row(map_entry, line_state.bg_attributes[map_x], tile_line, tile_x, current_pixel, highlight_tile);
+			map_x = (map_x + 1) & 0x1F;
+			tile_x = 0;
+		}
+	}
 
-					//Output Scanline data to RGBA - GBC Mode
-					else
-					{
-						if((y % 8) == 0)
-						{
-							u8 old_vram_bank = mem_link->vram_bank;
-						
-							//Always read CHR data from Bank 0
-							mem_link->vram_bank = 0;
-							map_entry = mem_link->read_byte(map_addr + x);
+	//BG disabled - Blank line, sprites are drawn over it
+	else
+	{
+		if(indexed_frame) { memset(scanline_index_data, INDEXED_BLANK, sizeof(scanline_index_data)); }
+		else { memset(scanline_pixel_data, 0xFF, sizeof(scanline_pixel_data)); }
 
-							//Read BG Map attributes from Bank 1
-							mem_link->vram_bank = 1;
-							bg_map_attribute = mem_link->read_byte(map_addr + x);
-							bg_palette = bg_map_attribute & 0x7;
-							bg_tile_bank = (bg_map_attribute & 0x8) ? 1 : 0;
+		memset(bg_win_raw_data, 0, sizeof(bg_win_raw_data));
+		memset(bg_priority, 0, sizeof(bg_priority));
+	}
 
-							if(mem_link->memory_map[REG_LCDC] & 0x10) { win_tile = gbc_tile_set_1[map_entry][bg_tile_bank]; }
-							else { map_entry = signed_tile(map_entry); win_tile = gbc_tile_set_0[map_entry][bg_tile_bank]; }
+	//Render Window Pixel Data - Nothing to draw if it starts past the right edge
+	if((line_state.ly - line_state.wy >= 0) && (lcdc & 0x20) && (line_state.wx < 167))
+	{
+		//The window starts at WX - 7, anything left of the screen is skipped
+		u8 tile_x = (line_state.wx < 7) ? (7 - line_state.wx) : 0;
+		current_pixel = (line_state.wx < 7) ? 0 : (line_state.wx - 7);
+		u8 window_line = (line_state.ly - line_state.wy) % 8;
 
-							if(bg_map_attribute & 0x20) { horizontal_flip(8, 8, win_tile.raw_data); }
-							if(bg_map_attribute & 0x40) { vertical_flip(8, 8, win_tile.raw_data); }
+		//Generate window pixel data for selected tiles - Stop at the right edge of the scanline
+		for(int x = 0; x < 32; x++)
+		{
+			bool highlight_tile = false;
+			map_entry = line_state.win_map[x];
 
-							mem_link->vram_bank = old_vram_bank;
-						}
+			//Check if tile can be highlighted - For BG tile dumping
+			if(config::dump_sprites)
+			{
+				int left_bound = current_pixel - tile_x;
+				int right_bound = left_bound + 8;
 
-						bg_priority[current_pixel] = (bg_map_attribute & 0x80) ? 1 : 0;
-						bg_win_raw_data[current_pixel] = win_tile.raw_data[y];
-						scanline_pixel_data[current_pixel] = background_colors_final[win_tile.raw_data[y]][bg_palette];
-					}	
+				if((mouse_x > left_bound) && (mouse_x < right_bound) && (mouse_y == line_state.ly))
+				{
+					if(lcdc & 0x10) { dump_tile_win = map_entry; dump_mode = 2; }
+					else { dump_tile_win = signed_tile(map_entry); dump_mode = 3; }
 				}
 
-				if((config::dump_sprites) && (map_entry == dump_tile_win)) { scanline_pixel_data[current_pixel] += 0x00700000; }
-
-				current_pixel++;
-				if(current_pixel == 0) { x = tile_upper_range; break; }
+				if(lcdc & 0x10) { highlight_tile = (map_entry == dump_tile_win); }
+				else { highlight_tile = (signed_tile(map_entry) == dump_tile_win); }
 			}
+
+			if(!draw_tile_row(map_entry, line_state.win_attributes[x], window_line, tile_x, current_pixel, highlight_tile)) { break; }
+			tile_x = 0;
 		}
 	}
 
 	//Render Sprite Pixel Data
-	if(mem_link->memory_map[REG_LCDC] & 0x02)
+	if(lcdc & 0x02)
 	{
-		//Simple list to keep track of which sprites (10 max) to render for scanline
-		u8 sprite_render_list[10];
-		u8 sprite_render_line[10];
-		u16 sprite_height = 0;
-		int sprite_counter = 0;
+		//Sprites (10 max) to render for this scanline
+		u8 current_line = line_state.ly;
+		int sprite_counter = (current_line < 144) ? line_sprite_count[current_line] : 0;
+		u8* sprite_render_list = line_sprite_list[current_line % 144];
+		u8* sprite_render_line = line_sprite_row[current_line % 144];
 
 		current_pixel = 0;
 
-		//Determine if in 8x8 or 8x16 mode
-		if(mem_link->memory_map[REG_LCDC] & 0x04) { sprite_height = 16; }
-		else { sprite_height = 8; }
-
-		//Cycle through all sprites to see if they're within height-range
-		for(int x = 0; x < 40; x++)
-		{
-			//Check to see if X coordinate is on screen
-			if(sprite_counter < 10)
-			{
-				//Check to see if Y coordinate is within rendering range
-				for(int y = 0; y < sprite_height; y++)
-				{
-					if((sprites[x].y + y) == mem_link->memory_map[REG_LY])
-					{
-						sprite_render_list[sprite_counter] = x;
-						sprite_render_line[sprite_counter] = y;
-						sprite_counter++;
-					}
-				}
-			}
-		}
-
 		if(sprite_counter != 0)
 		{
 			//Cycle through sprite list
@@ -641,6 +550,9 @@ void GPU::generate_scanline()
 				{
 					bool draw_sprite_pixel = false;
 
+					//Skip pixels off the left or right edge of the screen
+					if(current_pixel >= 160) { current_pixel++; continue; }
+
 					//Draw custom sprite data
 					if(sprites[current_sprite].custom_data_loaded) 
 					{
@@ -662,7 +574,12 @@ void GPU::generate_scanline()
 							if((sprites[current_sprite].raw_data[y] != 0) && (priority == 0)) { draw_sprite_pixel = true; }
 							else if((sprites[current_sprite].raw_data[y] != 0) && (priority == 1) && (bg_win_raw_data[current_pixel] == 0)) { draw_sprite_pixel = true; }
 
-							if(draw_sprite_pixel) 
+							if((draw_sprite_pixel) && (indexed_frame))
+							{
+								scanline_index_data[current_pixel] = INDEXED_OBJ | (pal << 2) | obp[sprites[current_sprite].raw_data[y]][pal];
+							}
+
+							else if(draw_sprite_pixel) 
 							{
 								switch(obp[sprites[current_sprite].raw_data[y]][pal])
 								{
@@ -693,7 +610,12 @@ void GPU::generate_scanline()
 							if((bg_priority[current_pixel] == 0) && (priority == 1) && (sprites[current_sprite].raw_data[y] != 0) && (bg_win_raw_data[current_pixel] == 0)) { draw_sprite_pixel = true; }
 							if((bg_priority[current_pixel] == 1) && (sprites[current_sprite].raw_data[y] != 0) && (bg_win_raw_data[current_pixel] == 0)) { draw_sprite_pixel = true; }
 						
-							if(draw_sprite_pixel)
+							if((draw_sprite_pixel) && (indexed_frame))
+							{
+								scanline_index_data[current_pixel] = INDEXED_OBJ | (gbc_pal << 2) | sprites[current_sprite].raw_data[y];
+							}
+
+							else if(draw_sprite_pixel)
 							{
 								scanline_pixel_data[current_pixel] = sprite_colors_final[sprites[current_sprite].raw_data[y]][gbc_pal];
 							}
@@ -707,20 +629,23 @@ void GPU::generate_scanline()
 	}
 
 	//Copy scanline data to final buffer
-	for(int x = 0; x < 0x100; x++)
+	if(indexed_frame)
 	{
-		final_pixel_data[(mem_link->memory_map[REG_LY] * 0x100) + x] = scanline_pixel_data[x];
+		gb_indexed_frame &frame = indexed_frames[draw_frame];
+		memcpy(&frame.pixel_data[line_state.ly * 160], scanline_index_data, 160);
+		frame.line_palette[line_state.ly] = frame.palette_count - 1;
 	}
+
+	else { memcpy(&final_pixel_data[line_state.ly * 160], scanline_pixel_data, 160 * 4); }
 }
 
 /****** Prepares sprites for rendering - Pulls data from OAM, sets sprite palettes, etc ******/
 void GPU::generate_sprites()
 {
-	u8 high_byte, low_byte = 0;
-	u8 high_bit, low_bit = 0;
-	u8 final_byte = 0;
+	bench_scope timer(bench::GPU_SPRITES);
+
+	finish_scanline();
 
-	u16 sprite_tile_addr = 0;
 	u16 sprite_height = 0;
 
 	//Read sprite attributes from OAM
@@ -743,6 +668,24 @@ void GPU::generate_sprites()
 
 	else { sprite_height = 8; }
 
+	//Build the list of sprites on each line - The first 10 sprites in OAM order are drawn
+	memset(line_sprite_count, 0, sizeof(line_sprite_count));
+
+	for(int x = 0; x < 40; x++)
+	{
+		for(int y = 0; y < sprite_height; y++)
+		{
+			int line = sprites[x].y + y;
+
+			if((line >= 0) && (line < 144) && (line_sprite_count[line] < 10))
+			{
+				line_sprite_list[line][line_sprite_count[line]] = x;
+				line_sprite_row[line][line_sprite_count[line]] = y;
+				line_sprite_count[line]++;
+			}
+		}
+	}
+
 	u8 sp_zero = mem_link->memory_map[REG_OBP0];
 	u8 sp_one = mem_link->memory_map[REG_OBP1];
 
@@ -765,68 +708,22 @@ void GPU::generate_sprites()
 	{
 		for(int x = 0; x < 40; x++)
 		{
-			sprite_tile_addr = (sprites[x].tile_number * 16) + 0x8000;
-			u8 pixel_counter = 0;
-
-			//Read Sprite Options
-			u8 pal = sprites[x].options & 0x10 ? 1 : 0;
+			//DMG always reads from VRAM Bank 0, GBC sprites choose their bank
+			u8 sprite_vram_bank = ((config::gb_type == 2) && (sprites[x].options & 0x8)) ? 1 : 0;
 
-			//Cycles through tile
-			for(int y = 0; y < sprite_height; y++)
-			{
-				//Grab High and Low Bytes for Tile - DMG mode
-				if(config::gb_type != 2)
-				{
-					high_byte = mem_link->read_byte(sprite_tile_addr);
-					low_byte = mem_link->read_byte(sprite_tile_addr+1);
-				}
-
-				//Grab High and Low Bytes for Tile - GBC mode
-				else
-				{
-					u8 old_vram_bank = mem_link->vram_bank;
-					u8 temp_vram_bank = (sprites[x].options & 0x8) ? 1 : 0;
-					mem_link->vram_bank = temp_vram_bank;
-
-					high_byte = mem_link->read_byte(sprite_tile_addr);
-					low_byte = mem_link->read_byte(sprite_tile_addr+1);
-
-					mem_link->vram_bank = old_vram_bank;
-				}
-
-				//Cycle through High and Low bytes
-				for(int z = 7; z >= 0; z--)
-				{
-					high_bit = (high_byte >> z) & 0x01;
-					low_bit = (low_byte >> z) & 0x01;
-					final_byte = high_bit + (low_bit * 2);
-
-					sprites[x].raw_data[pixel_counter] = final_byte;
-					pixel_counter++;
-				}
-
-				sprite_tile_addr += 2;
-			}
+			//Flipping is applied while decoding
+			tile::decode(&mem_link->video_ram[(sprite_vram_bank * 0x2000) + (sprites[x].tile_number * 16)], sprite_height, sprites[x].raw_data,
+			(sprites[x].options & 0x20), (sprites[x].options & 0x40));
 		}
 	}
 
-	//Handle horizontal and vertical flipping
+	//Handle horizontal and vertical flipping for custom sprite data
 	for(int x = 0; x < 40; x++)
 	{
-		u8 h_flip = sprites[x].options & 0x20 ? 1 : 0;
-		u8 v_flip = sprites[x].options & 0x40 ? 1 : 0;
-
-		if(h_flip == 1) 
-		{ 
-			horizontal_flip(8, sprite_height, sprites[x].raw_data);
-			horizontal_flip(8, sprite_height, sprites[x].custom_data); 
-		}
+		if(!sprites[x].custom_data_loaded) { continue; }
 
-		if(v_flip == 1) 
-		{ 
-			vertical_flip(8, sprite_height, sprites[x].raw_data);
-			vertical_flip(8, sprite_height, sprites[x].custom_data); 
-		}
+		if(sprites[x].options & 0x20) { horizontal_flip(8, sprite_height, sprites[x].custom_data); }
+		if(sprites[x].options & 0x40) { vertical_flip(8, sprite_height, sprites[x].custom_data); }
 	}
 }
 	
@@ -834,45 +731,66 @@ void GPU::generate_sprites()
 /****** Render final frame ******/
 void GPU::render_screen() 
 {
+	bench_scope timer(bench::GPU_RENDER);
+
+	//Skipped frames are never shown - Keep the last drawn frame on screen
+	if(skip_frame)
+	{
+		frame_count++;
+		begin_frame();
+		return;
+	}
+
+	//Every line of the frame has to be drawn first
+	finish_scanline();
+
+	//Draw to the presenter's back buffer when it's running, otherwise to the source surface
+	SDL_Surface* frame = (presenter != NULL) ? frame_surfaces[back_buffer] : src_screen;
+
 	//Lock source surface
-	if(SDL_MUSTLOCK(src_screen)){ SDL_LockSurface(src_screen); }
-	u32* out_pixel_data = (u32*)src_screen->pixels;
+	if(SDL_MUSTLOCK(frame)){ SDL_LockSurface(frame); }
+	u32* out_pixel_data = (u32*)frame->pixels;
 
 	//LCD On - Draw background to framebuffer
 	if(mem_link->memory_map[REG_LCDC] & 0x80) 
 	{
-		//Technically, it's only necessary to copy scanlines 0-143
-		//Scanlines 144+ aren't even rendered by generate_scanline()
-		for(int a = 0; a < 0x9000; a++) { out_pixel_data[a] = final_pixel_data[a]; }
+		//Indexed frames are converted in one pass - Headless mode waits until the frame is actually needed
+		if(indexed_frame)
+		{
+			draw_frame ^= 1;
+			frame_converted = false;
+			if(!config::headless) { convert_frame(out_pixel_data, frame->pitch / 4); }
+		}
+
+		else
+		{
+			for(int y = 0; y < 144; y++) { memcpy(&out_pixel_data[y * (frame->pitch / 4)], &final_pixel_data[y * 160], 160 * 4); }
+			frame_converted = true;
+		}
 	}
 
 	//LCD Off - Draw white pixels to framebuffer
 	else
 	{
-		memset(out_pixel_data, 0xFFFFFFFF, sizeof(out_pixel_data));
+		memset(out_pixel_data, 0xFF, frame->pitch * 144);
+		frame_converted = true;
 	}
 
 	//Unlock source surface
-	if(SDL_MUSTLOCK(src_screen)){ SDL_UnlockSurface(src_screen); }
+	if(SDL_MUSTLOCK(frame)){ SDL_UnlockSurface(frame); }
 
-	//Scale the source image...
-	if((config::use_scaling) && (!config::use_opengl)) 
-	{
-		apply_scaling(src_screen, temp_screen);
-		SDL_BlitSurface(temp_screen, 0, gpu_screen, 0);
-	}
-	
-	//Or just blit to unscaled image to screen
-	else { SDL_BlitSurface(src_screen, 0, gpu_screen, 0); }
+	frame_count++;
 
-	//Blit via SDL
-	if(!config::use_opengl)
+	//Headless mode - Nothing to blit to, and no framelimit
+	if(config::headless)
 	{
-		if(SDL_Flip(gpu_screen) == -1) { std::cout<<"Could not blit? \n"; }
+		begin_frame();
+		return;
 	}
 
-	//Blit via OpenGL
-	else { opengl_blit(); }
+	//Hand the frame to the presenter thread, or scale and blit it here
+	if(presenter != NULL) { publish_frame(); }
+	else { present_frame(src_screen); }
 
 	//Limit FPS to 60
 	if(!config::turbo)
@@ -882,9 +800,240 @@ void GPU::render_screen()
 		else { std::cout<<"GPU : Late Blit\n"; }
 	}
 
-	//Clear pixel data after frame draw
-	memset(scanline_pixel_data, 0xFFFFFFFF, sizeof(scanline_pixel_data));
-	memset(final_pixel_data, 0xFFFFFFFF, sizeof(final_pixel_data));
+	begin_frame();
+}
+
+/****** Start a new frame - Every line is drawn while the LCD is on, so nothing needs clearing ******/
+void GPU::begin_frame()
+{
+	//Fast-forward draws only 1 of every N frames, or none at all in logic-only mode
+	skip_frame = (config::turbo) && (!config::dump_sprites) && ((config::logic_only) || ((frame_count % config::frame_skip) != 0));
+
+	//Custom graphics and highlighted tiles need full ARGB colors
+	indexed_frame = (config::indexed_framebuffer) && (!config::load_sprites) && (!config::dump_sprites);
+
+	if(indexed_frame)
+	{
+		indexed_frames[draw_frame].palette_count = 0;
+		palette_dirty = true;
+	}
+}
+
+/****** Store the current colors for the indexed frame - Called when the palettes changed since the last scanline ******/
+void GPU::latch_palette()
+{
+	gb_indexed_frame &frame = indexed_frames[draw_frame];
+	if(frame.palette_count == 144) { frame.palette_count--; }
+
+	u32* colors = frame.palettes[frame.palette_count++];
+
+	for(int x = 0; x < 8; x++)
+	{
+		for(int y = 0; y < 4; y++)
+		{
+			//GBC - Every BG and sprite palette
+			if(config::gb_type == 2)
+			{
+				colors[(x << 2) | y] = background_colors_final[y][x];
+				colors[INDEXED_OBJ | (x << 2) | y] = sprite_colors_final[y][x];
+			}
+
+			//DMG - The shades of the BG and both sprite palettes
+			else
+			{
+				colors[(x << 2) | y] = config::DMG_PAL_BG[y];
+				colors[INDEXED_OBJ | (x << 2) | y] = config::DMG_PAL_OBJ[y][x & 0x1];
+			}
+		}
+	}
+
+	colors[INDEXED_BLANK] = 0xFFFFFFFF;
+	palette_dirty = false;
+}
+
+/****** Convert the last finished indexed frame to ARGB - Output rows are out_width pixels apart ******/
+void GPU::convert_frame(u32* out_pixel_data, u32 out_width)
+{
+	gb_indexed_frame &frame = indexed_frames[draw_frame ^ 1];
+
+	for(int y = 0; y < 144; y++)
+	{
+		u32* colors = frame.palettes[frame.line_palette[y]];
+		u8* in_line = &frame.pixel_data[y * 160];
+		u32* out_line = &out_pixel_data[y * out_width];
+
+		for(int x = 0; x < 160; x++) { out_line[x] = colors[in_line[x]]; }
+	}
+
+	frame_converted = true;
+}
+
+/****** Hash the visible 160x144 area of the last frame - 64-bit FNV-1a ******/
+u64 GPU::frame_hash()
+{
+	u64 hash = 0xCBF29CE484222325ULL;
+
+	finish_scanline();
+
+	if(SDL_MUSTLOCK(src_screen)){ SDL_LockSurface(src_screen); }
+	u32* pixel_data = (u32*)src_screen->pixels;
+
+	if(!frame_converted) { convert_frame(pixel_data, src_screen->pitch / 4); }
+
+	for(int y = 0; y < 144; y++)
+	{
+		for(int x = 0; x < 160; x++)
+		{
+			u32 pixel = pixel_data[(y * (src_screen->pitch / 4)) + x];
+
+			//Hash each byte of the pixel, lowest first
+			for(int z = 0; z < 4; z++)
+			{
+				hash ^= (pixel >> (z * 8)) & 0xFF;
+				hash *= 0x100000001B3ULL;
+			}
+		}
+	}
+
+	if(SDL_MUSTLOCK(src_screen)){ SDL_UnlockSurface(src_screen); }
+
+	return hash;
+}
+
+/****** Save the visible 160x144 area of the last frame to a BMP file ******/
+bool GPU::dump_frame(std::string filename)
+{
+	SDL_Surface* frame = SDL_CreateRGBSurface(SDL_SWSURFACE, 160, 144, 32, 0, 0, 0, 0);
+	if(frame == NULL) { return false; }
+
+	finish_scanline();
+
+	if(SDL_MUSTLOCK(src_screen)){ SDL_LockSurface(src_screen); }
+	if(SDL_MUSTLOCK(frame)){ SDL_LockSurface(frame); }
+
+	if(!frame_converted) { convert_frame((u32*)src_screen->pixels, src_screen->pitch / 4); }
+
+	for(int y = 0; y < 144; y++)
+	{
+		memcpy((u8*)frame->pixels + (y * frame->pitch), (u8*)src_screen->pixels + (y * src_screen->pitch), 160 * 4);
+	}
+
+	if(SDL_MUSTLOCK(frame)){ SDL_UnlockSurface(frame); }
+	if(SDL_MUSTLOCK(src_screen)){ SDL_UnlockSurface(src_screen); }
+
+	bool result = (SDL_SaveBMP(frame, filename.c_str()) == 0);
+	SDL_FreeSurface(frame);
+
+	if(result) { std::cout<<"GPU : Saved frame - " << filename << "\n"; }
+	else { std::cout<<"GPU : Could not save frame - " << filename << "\n"; }
+
+	return result;
+}
+
+/****** Save GPU state ******/
+void GPU::save_state(std::vector<u8> &state)
+{
+	finish_scanline();
+
+	savestate::write(state, gpu_mode);
+	savestate::write(state, gpu_mode_change);
+	savestate::write(state, gpu_clock);
+	savestate::write(state, lcd_enabled);
+	savestate::write(state, current_hdma_line);
+	savestate::write(state, last_bgp);
+
+	//Palettes - The DMG palettes are changed by the GBC BIOS
+	savestate::write(state, sprite_colors_raw);
+	savestate::write(state, background_colors_raw);
+	savestate::write(state, sprite_colors_final);
+	savestate::write(state, background_colors_final);
+	savestate::write(state, config::DMG_PAL_BG);
+	savestate::write(state, config::DMG_PAL_OBJ);
+
+	//Scanlines of the current frame drawn so far - The frame is already out during VBlank
+	u8 lines = (gpu_mode == 1) ? 0 : std::min(mem_link->memory_map[REG_LY] + 1, 144);
+	savestate::write(state, lines);
+	savestate::write(state, indexed_frame);
+
+	//Indexed frames also keep the colors their lines were drawn with
+	if(indexed_frame)
+	{
+		gb_indexed_frame &frame = indexed_frames[draw_frame];
+
+		savestate::write(state, palette_dirty);
+		savestate::write(state, frame.pixel_data, lines * 160);
+		savestate::write(state, frame.line_palette, lines);
+		savestate::write(state, frame.palette_count);
+		savestate::write(state, frame.palettes, frame.palette_count * sizeof(frame.palettes[0]));
+	}
+
+	else { savestate::write(state, final_pixel_data, lines * 160 * 4); }
+}
+
+/****** Load GPU state ******/
+bool GPU::load_state(const std::vector<u8> &state, u32 &offset)
+{
+	finish_scanline();
+
+	u8 lines = 0;
+
+	bool result = savestate::read(state, offset, gpu_mode)
+	&& savestate::read(state, offset, gpu_mode_change)
+	&& savestate::read(state, offset, gpu_clock)
+	&& savestate::read(state, offset, lcd_enabled)
+	&& savestate::read(state, offset, current_hdma_line)
+	&& savestate::read(state, offset, last_bgp)
+	&& savestate::read(state, offset, sprite_colors_raw)
+	&& savestate::read(state, offset, background_colors_raw)
+	&& savestate::read(state, offset, sprite_colors_final)
+	&& savestate::read(state, offset, background_colors_final)
+	&& savestate::read(state, offset, config::DMG_PAL_BG)
+	&& savestate::read(state, offset, config::DMG_PAL_OBJ)
+	&& savestate::read(state, offset, lines)
+	&& (lines <= 144)
+	&& savestate::read(state, offset, indexed_frame);
+
+	if(!result) { return false; }
+
+	//The rest of the frame is drawn the same way it was started, even if --indexed differs
+	if(indexed_frame)
+	{
+		gb_indexed_frame &frame = indexed_frames[draw_frame];
+
+		result = savestate::read(state, offset, palette_dirty)
+		&& savestate::read(state, offset, frame.pixel_data, lines * 160)
+		&& savestate::read(state, offset, frame.line_palette, lines)
+		&& savestate::read(state, offset, frame.palette_count)
+		&& (frame.palette_count <= 144)
+		&& savestate::read(state, offset, frame.palettes, frame.palette_count * sizeof(frame.palettes[0]));
+
+		if(!result) { return false; }
+
+		for(int x = 0; x < lines; x++)
+		{
+			if(frame.line_palette[x] >= 144) { return false; }
+		}
+	}
+
+	else if(!savestate::read(state, offset, final_pixel_data, lines * 160 * 4)) { return false; }
+
+	//Decoded tiles and sprites are rebuilt from VRAM and OAM instead of being stored
+	memset(mem_link->gpu_dirty_tiles, 0xFF, sizeof(mem_link->gpu_dirty_tiles));
+	mem_link->gpu_update_bg_tile = true;
+	update_tiles();
+	generate_sprites();
+
+	return true;
+}
+
+/****** GPU cycles until the next mode or line change - 0 when a new mode still has to be entered, -1 while the LCD is off ******/
+int GPU::event_cycles()
+{
+	if(!lcd_enabled) { return -1; }
+	if(gpu_mode_change != gpu_mode) { return 0; }
+
+	int mode_end = (gpu_mode == 2) ? 80 : ((gpu_mode == 3) ? 252 : 456);
+	return (gpu_clock >= mode_end) ? 0 : (mode_end - gpu_clock);
 }
 
 /****** Execute GPU Operations ******/
@@ -899,16 +1048,8 @@ void GPU::step(int cpu_clock)
 		gpu_mode = 2;
 	}
  
-	//Update background tile
-	if(mem_link->gpu_update_bg_tile)
-	{
-		if(config::gb_type != 2) { update_bg_tile(); }
-		else { update_gbc_bg_tile(); }
-		mem_link->gpu_update_bg_tile = false;
-	}
-
-	//Update sprites
-	if(mem_link->gpu_update_sprite)
+	//Update sprites - Skipped frames leave this until the next frame that gets drawn
+	if((mem_link->gpu_update_sprite) && (!skip_frame))
 	{
 		generate_sprites();
 		mem_link->gpu_update_sprite = false;
@@ -917,6 +1058,8 @@ void GPU::step(int cpu_clock)
 	//Update background color palettes on the GBC
 	if((mem_link->gpu_update_bg_colors) && (config::gb_type == 2))
 	{
+		finish_scanline();
+
 		u8 hi_lo = (mem_link->memory_map[REG_BCPS] & 0x1);
 		u8 color = (mem_link->memory_map[REG_BCPS] >> 1) & 0x3;
 		u8 palette = (mem_link->memory_map[REG_BCPS] >> 3) & 0x7;
@@ -968,11 +1111,14 @@ void GPU::step(int cpu_clock)
 		}
 
 		mem_link->gpu_update_bg_colors = false;
+		palette_dirty = true;
 	}
 
 	//Update sprite color palettes on the GBC
 	if((mem_link->gpu_update_sprite_colors) && (config::gb_type == 2))
 	{
+		finish_scanline();
+
 		u8 hi_lo = (mem_link->memory_map[REG_OCPS] & 0x1);
 		u8 color = (mem_link->memory_map[REG_OCPS] >> 1) & 0x3;
 		u8 palette = (mem_link->memory_map[REG_OCPS] >> 3) & 0x7;
@@ -1029,6 +1175,7 @@ void GPU::step(int cpu_clock)
 		}
 
 		mem_link->gpu_update_sprite_colors = false;
+		palette_dirty = true;
 	}
 
 	//General HDMA
@@ -1070,6 +1217,9 @@ void GPU::step(int cpu_clock)
 				//Render scanline when 1st entering Mode 0
 				if(gpu_mode_change != 0)
 				{
+					//Decode tiles written to since the last scanline
+					update_tiles();
+
 					//Horizontal blanking DMA
 					if((config::gb_type == 2) && (mem_link->gpu_hdma_in_progress) && (mem_link->gpu_hdma_type == 1))
 					{
@@ -1151,6 +1301,8 @@ void GPU::step(int cpu_clock)
 					//VBlank STAT INT
 					if(mem_link->memory_map[REG_STAT] & 0x10) { mem_link->memory_map[REG_IF] |= 2; }
 
+					update_tiles();
+
 					//Dump sprites and BG Tiles every VBlank
 					if(config::dump_sprites) 
 					{ 
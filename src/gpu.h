@@ -16,20 +16,31 @@
 
 #include "SDL/SDL.h"
 #include "SDL/SDL_opengl.h"
+#include "SDL/SDL_thread.h"
 #include <string>
 #include <iostream>
 #include <algorithm>
 #include <vector>
 #include <map>
+#include <atomic>
 
 #include "common.h"
 #include "mmu.h"
 #include "config.h"
 #include "hash.h"
+#include "tile.h"
+
+//Indexed framebuffer - Bit 5 picks the sprite palettes, bits 2-4 the palette, bits 0-1 the color
+const u8 INDEXED_OBJ = 0x20;
+const u8 INDEXED_BLANK = 0x40;
+const u8 INDEXED_COLORS = 0x41;
+
+//Triple buffer - Set in the ready buffer index while it holds a frame the presenter hasn't shown yet
+const u8 READY_NEW = 0x4;
 
 struct gb_sprite
 {
-	u32 raw_data [0x80];
+	u8 raw_data [0x80];
 	u32 custom_data[0x80];
 	u8 x;
 	int y; //TODO: Find a better way to handle off-screen coordinates
@@ -41,7 +52,7 @@ struct gb_sprite
 
 struct gb_tile
 {
-	u32 raw_data[0x40];
+	u8 raw_data[0x40];
 	u32 custom_data[0x40];
 	std::string hash;
 	bool custom_data_loaded;
@@ -49,7 +60,35 @@ struct gb_tile
 
 struct gbc_tile
 {
-	u32 raw_data[0x40];
+	u8 raw_data[0x40];
+};
+
+struct gb_scanline_state
+{
+	//LCD registers the scanline is drawn with
+	u8 ly;
+	u8 lcdc;
+	u8 scx;
+	u8 scy;
+	u8 wx;
+	u8 wy;
+	u8 bgp;
+
+	//Tile map rows and GBC map attributes under the scanline
+	u8 bg_map[32];
+	u8 bg_attributes[32];
+	u8 win_map[32];
+	u8 win_attributes[32];
+};
+
+struct gb_indexed_frame
+{
+	u8 pixel_data[160 * 144];
+
+	//Colors in use when each line was drawn - A new set is only stored when the palettes change
+	u8 line_palette[144];
+	u32 palettes[144][INDEXED_COLORS];
+	u8 palette_count;
 };
 
 class GPU
@@ -64,12 +103,40 @@ class GPU
 	SDL_Surface* temp_screen;
 	GLuint gpu_texture;
 
+	//Frames rendered since startup
+	u32 frame_count;
+
+	//Presenter thread - Scales and blits finished frames so the emulation never waits on the display
+	SDL_Thread* presenter;
+	std::atomic<bool> screen_reset_request;
+	std::atomic<bool> screenshot_request;
+
+	//Render worker thread - Draws each scanline while the CPU moves on to the next one
+	SDL_Thread* render_worker;
+
 	//Core Functions
 	GPU();
 	~GPU();
 
 	void step(int cpu_clock);
+	int event_cycles();
 	void opengl_init();
+	void init_screen();
+
+	bool start_presenter();
+	void stop_presenter();
+	void presenter_loop();
+
+	bool start_render_worker();
+	void stop_render_worker();
+	void render_worker_loop();
+
+	u64 frame_hash();
+	bool dump_frame(std::string filename);
+
+	//Save states
+	void save_state(std::vector<u8> &state);
+	bool load_state(const std::vector<u8> &state, u32 &offset);
 
 	private:
 
@@ -82,6 +149,9 @@ class GPU
 
 	bool lcd_enabled;
 
+	//Fast-forward - Skipped frames run the LCD timing and interrupts as usual, but draw nothing
+	bool skip_frame;
+
 	//Tile set data
 	gb_tile tile_set_1[0x100];
 	gb_tile tile_set_0[0x100];
@@ -89,16 +159,43 @@ class GPU
 	gbc_tile gbc_tile_set_1[0x100][2];
 	gbc_tile gbc_tile_set_0[0x100][2];
 
-	gbc_tile win_tile;
-	gbc_tile bg_tile;
-
-	//Pixel data
-	u32 scanline_pixel_data [0x100];
-	u32 final_pixel_data [0x10000];
+	//Pixel data - Only the visible 160x144 area is drawn
+	u32 scanline_pixel_data [160];
+
+	//Color indices and GBC priority of the BG/window pixels in the current scanline - Used when drawing sprites
+	u8 bg_win_raw_data[160];
+	u8 bg_priority[160];
+	u32 final_pixel_data [160 * 144];
+
+	//Indexed framebuffer - Frames are drawn to one buffer while the last finished one waits to be converted
+	bool indexed_frame;
+	bool palette_dirty;
+	bool frame_converted;
+	u8 draw_frame;
+	u8 scanline_index_data[160];
+	gb_indexed_frame indexed_frames[2];
+
+	//Triple buffer shared with the presenter thread - The emulation draws to the back buffer, the presenter shows the front one
+	//The middle buffer holds the newest finished frame, flagged by READY_NEW until the presenter takes it
+	SDL_Surface* frame_surfaces[3];
+	u8 back_buffer;
+	u8 front_buffer;
+	std::atomic<u8> ready_buffer;
+	std::atomic<bool> presenter_running;
+	SDL_sem* frame_ready;
+	SDL_sem* screen_ready;
+
+	//Scanline handed to the render worker - Captured when it's queued, so the CPU can keep changing LCD registers and VRAM
+	gb_scanline_state line_state;
+	alignas(64) std::atomic<bool> line_queued;
+	alignas(64) std::atomic<bool> worker_sleeping;
+	std::atomic<bool> worker_running;
+	SDL_sem* worker_wakeup;
 
 	//Palettes
 	u8 bgp[4];
 	u8 obp[4][2];
+	u32 dmg_bg_colors[4];
 
 	u16 sprite_colors_raw[4][8];
 	u16 background_colors_raw[4][8];
@@ -108,6 +205,11 @@ class GPU
 
 	gb_sprite sprites[40];
 
+	//Sprites on each visible line (10 max) and the sprite row drawn there - Rebuilt by generate_sprites()
+	u8 line_sprite_count[144];
+	u8 line_sprite_list[144][10];
+	u8 line_sprite_row[144][10];
+
 	//HDMA
 	u8 current_hdma_line;
 
@@ -115,15 +217,29 @@ class GPU
 	std::vector<std::string> sprite_hash_list;
 	std::vector<u8> tile_set_0_updates;
 	std::vector<u8> tile_set_1_updates;
+	bool tile_set_0_listed[0x100];
+	bool tile_set_1_listed[0x100];
 	std::map<std::string, SDL_Surface*> custom_sprite_list;
 	std::map<std::string, SDL_Surface*>::iterator custom_sprite_list_itr;
 
 	void render_screen();
+	void begin_frame();
+	void latch_palette();
+	void convert_frame(u32* out_pixel_data, u32 out_width);
+	void publish_frame();
+	void present_frame(SDL_Surface* frame);
 	void scanline_compare();
+	void update_tiles();
 	void update_bg_tile();
 	void update_gbc_bg_tile();
+	void decode_tile(u8 bank, u16 tile_number, u8 pixel_data[]);
 
 	void generate_scanline();
+	void capture_scanline();
+	void render_scanline();
+	void queue_scanline();
+	void finish_scanline();
+	bool draw_tile_row(u8 map_entry, u8 map_attribute, u8 tile_line, u8 tile_x, u8 &current_pixel, bool highlight_tile);
 	void generate_sprites();
 
 	void horizontal_flip(u16 width, u16 height, u32 pixel_data[]);
@@ -14,14 +14,17 @@
 
 #include "hotkeys.h"
 #include "config.h"
+#include "savestate.h"
+#include "rewind.h"
 
 /****** Process key input - Do hotkey action or send input to Game Pad ******/
-void process_keys(CPU& z80, GPU& gb_gpu, SDL_Event& event)
+void process_keys(CPU& z80, GPU& gb_gpu, APU& gb_apu, SDL_Event& event)
 {
 	//Quit on Q or ESC
 	if((event.type == SDL_KEYDOWN) && ((event.key.keysym.sym == SDLK_q) || (event.key.keysym.sym == SDLK_ESCAPE)))
 	{
 		z80.running = false; 
+		gb_gpu.stop_presenter();
 		SDL_Quit();
 	}
 
@@ -35,8 +38,24 @@ void process_keys(CPU& z80, GPU& gb_gpu, SDL_Event& event)
 	//Mouse click
 	else if((event.type == SDL_MOUSEBUTTONDOWN) && (event.button.button == SDL_BUTTON_LEFT)) { config::mouse_click = true; }
 
-	//Screenshot on F9
-	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F9)) { take_screenshot(gb_gpu); }
+	//Save state on F5
+	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F5)) { save_state_file(z80, gb_gpu, gb_apu, config::rom_file + ".state"); }
+
+	//Load state on F8
+	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F8)) { load_state_file(z80, gb_gpu, gb_apu, config::rom_file + ".state"); }
+
+	//Rewind while Backspace is held
+	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_BACKSPACE)) { rewind_buffer::active = true; }
+
+	//Stop rewinding
+	else if((event.type == SDL_KEYUP) && (event.key.keysym.sym == SDLK_BACKSPACE)) { rewind_buffer::active = false; }
+
+	//Screenshot on F9 - Taken by the presenter thread when it owns the screen
+	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F9))
+	{
+		if(gb_gpu.presenter != NULL) { gb_gpu.screenshot_request = true; }
+		else { take_screenshot(gb_gpu); }
+	}
 
 	//Switch between fullscreen and windowed mode
 	else if((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_F10)) { toggle_fullscreen(gb_gpu); }
@@ -79,16 +98,7 @@ void toggle_fullscreen(GPU& gb_gpu)
 	if(config::flags == 0x80000000) { config::flags = 0; }
 	else { config::flags = 0x80000000; }
 
-	//Initialize the screen - account for scaling, fullscreen
-	if((!config::use_scaling) && (!config::use_opengl)) 
-	{ 
-		gb_gpu.gpu_screen = SDL_SetVideoMode(160, 144, 32, SDL_SWSURFACE | config::flags); 
-	}
-	
-	else if((config::use_scaling) && (!config::use_opengl)) 
-	{ 
-		gb_gpu.gpu_screen = SDL_SetVideoMode((160 * config::scaling_factor), (144 * config::scaling_factor), 32, SDL_SWSURFACE | config::flags); 
-	}
-	
-	else if(config::use_opengl) { gb_gpu.opengl_init(); }
+	//Initialize the screen - account for scaling, fullscreen - Done by the presenter thread when it owns the screen
+	if(gb_gpu.presenter != NULL) { gb_gpu.screen_reset_request = true; }
+	else { gb_gpu.init_screen(); }
 }
\ No newline at end of file
@@ -15,8 +15,9 @@
 #include "SDL/SDL.h"
 #include "z80.h"
 #include "gpu.h"
+#include "apu.h"
 
-void process_keys(CPU& z80, GPU& gb_gpu, SDL_Event& event);
+void process_keys(CPU& z80, GPU& gb_gpu, APU& gb_apu, SDL_Event& event);
 void take_screenshot(GPU& gb_gpu);
 void toggle_fullscreen(GPU& gb_gpu);
 
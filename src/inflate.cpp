@@ -0,0 +1,369 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : inflate.cpp
+// Date : October 17, 2026
+// Description : Deflate decompression
+//
+// Minimal decoder for raw deflate streams, as found in gzip and zip archives
+// Reads compressed data from a stream in chunks and writes straight into the output buffer
+
+#include <vector>
+#include <cstring>
+
+#include "inflate.h"
+
+namespace
+{
+	//Canonical Huffman code - Codes up to 9 bits long are decoded with a single table lookup
+	const u32 FAST_BITS = 9;
+
+	struct huffman
+	{
+		u16 count[16];
+		u16 symbol[288];
+		u16 fast[1 << FAST_BITS];
+	};
+
+	//Base values and extra bits for length and distance symbols
+	const u16 length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const u8 length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const u16 dist_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const u8 dist_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	//Order code length code lengths are stored in
+	const u8 length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	struct inflate_state
+	{
+		std::istream* input;
+		u32 input_left;
+		std::vector<u8> chunk;
+		u32 chunk_pos;
+		u32 chunk_end;
+
+		//Bits are consumed from the bottom of the buffer
+		u32 bit_buffer;
+		u32 bit_count;
+
+		//Zero bytes fed in after the end of the input - Only an error if they are actually used
+		u32 overrun;
+
+		u8* output;
+		u32 output_size;
+		u32 output_pos;
+
+		huffman lit_table;
+		huffman dist_table;
+	};
+
+	/****** Next byte of compressed data ******/
+	u8 next_byte(inflate_state &s)
+	{
+		if(s.chunk_pos == s.chunk_end)
+		{
+			u32 length = (s.input_left < inflate::CHUNK_SIZE) ? s.input_left : inflate::CHUNK_SIZE;
+			s.input->read(reinterpret_cast<char*> (&s.chunk[0]), length);
+			length = s.input->gcount();
+
+			s.input_left -= length;
+			s.chunk_pos = 0;
+			s.chunk_end = length;
+
+			if(length == 0)
+			{
+				s.overrun++;
+				return 0;
+			}
+		}
+
+		return s.chunk[s.chunk_pos++];
+	}
+
+	/****** Make sure at least 25 bits are buffered ******/
+	inline void refill(inflate_state &s)
+	{
+		while(s.bit_count <= 24)
+		{
+			s.bit_buffer |= ((u32)next_byte(s) << s.bit_count);
+			s.bit_count += 8;
+		}
+	}
+
+	/****** Read up to 16 bits ******/
+	inline u32 bits(inflate_state &s, u32 count)
+	{
+		refill(s);
+		u32 value = s.bit_buffer & ((1 << count) - 1);
+		s.bit_buffer >>= count;
+		s.bit_count -= count;
+		return value;
+	}
+
+	/****** Build a Huffman code from its code lengths - Fails if the lengths describe too many codes ******/
+	bool build(huffman &table, const u8* lengths, u32 count)
+	{
+		u16 offsets[16];
+		u16 next_code[16];
+
+		memset(table.count, 0, sizeof(table.count));
+		memset(table.fast, 0, sizeof(table.fast));
+
+		for(u32 x = 0; x < count; x++) { table.count[lengths[x]]++; }
+		table.count[0] = 0;
+
+		int left = 1;
+		for(u32 len = 1; len < 16; len++)
+		{
+			left = (left << 1) - table.count[len];
+			if(left < 0) { return false; }
+		}
+
+		offsets[1] = 0;
+		next_code[1] = 0;
+
+		for(u32 len = 1; len < 15; len++)
+		{
+			offsets[len + 1] = offsets[len] + table.count[len];
+			next_code[len + 1] = (next_code[len] + table.count[len]) << 1;
+		}
+
+		for(u32 x = 0; x < count; x++)
+		{
+			u32 len = lengths[x];
+			if(len == 0) { continue; }
+
+			table.symbol[offsets[len]++] = x;
+			u32 code = next_code[len]++;
+
+			//Codes are stored starting from their highest bit, so reverse them for lookups
+			if(len <= FAST_BITS)
+			{
+				u32 reversed = 0;
+				for(u32 bit = 0; bit < len; bit++) { reversed |= ((code >> bit) & 0x1) << (len - 1 - bit); }
+				for(u32 entry = reversed; entry < (1 << FAST_BITS); entry += (1 << len)) { table.fast[entry] = (x << 4) | len; }
+			}
+		}
+
+		return true;
+	}
+
+	/****** Decode one symbol - Returns -1 for invalid codes ******/
+	int decode(inflate_state &s, huffman &table)
+	{
+		refill(s);
+
+		u16 entry = table.fast[s.bit_buffer & ((1 << FAST_BITS) - 1)];
+
+		if(entry != 0)
+		{
+			s.bit_buffer >>= (entry & 0xF);
+			s.bit_count -= (entry & 0xF);
+			return entry >> 4;
+		}
+
+		//Longer codes are walked one bit at a time
+		int code = 0;
+		int first = 0;
+		int index = 0;
+
+		for(u32 len = 1; len < 16; len++)
+		{
+			code |= s.bit_buffer & 0x1;
+			s.bit_buffer >>= 1;
+			s.bit_count--;
+
+			int count = table.count[len];
+			if((code - count) < first) { return table.symbol[index + (code - first)]; }
+
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+
+		return -1;
+	}
+
+	/****** Copy a stored block ******/
+	bool stored_block(inflate_state &s)
+	{
+		//Skip to the next byte boundary
+		bits(s, s.bit_count & 0x7);
+
+		u32 length = bits(s, 16);
+		u32 check = bits(s, 16);
+
+		if((length != (~check & 0xFFFF)) || ((s.output_pos + length) > s.output_size)) { return false; }
+
+		while(length--) { s.output[s.output_pos++] = bits(s, 8); }
+		return true;
+	}
+
+	/****** Decode a block of literals and matches ******/
+	bool compressed_block(inflate_state &s)
+	{
+		while(true)
+		{
+			int symbol = decode(s, s.lit_table);
+
+			//Literal byte
+			if(symbol < 256)
+			{
+				if((symbol < 0) || (s.output_pos == s.output_size)) { return false; }
+				s.output[s.output_pos++] = symbol;
+			}
+
+			//End of block
+			else if(symbol == 256) { return true; }
+
+			//Match - Copy from earlier output
+			else
+			{
+				symbol -= 257;
+				if(symbol >= 29) { return false; }
+				u32 length = length_base[symbol] + bits(s, length_extra[symbol]);
+
+				symbol = decode(s, s.dist_table);
+				if((symbol < 0) || (symbol >= 30)) { return false; }
+				u32 distance = dist_base[symbol] + bits(s, dist_extra[symbol]);
+
+				if((distance > s.output_pos) || ((s.output_pos + length) > s.output_size)) { return false; }
+
+				u8* source = s.output + s.output_pos - distance;
+				u8* dest = s.output + s.output_pos;
+				s.output_pos += length;
+
+				//Overlapping copies repeat the last bytes, so go byte by byte
+				while(length--) { *dest++ = *source++; }
+			}
+		}
+	}
+
+	/****** Build the fixed codes ******/
+	bool fixed_tables(inflate_state &s)
+	{
+		u8 lengths[288];
+
+		for(u32 x = 0; x < 144; x++) { lengths[x] = 8; }
+		for(u32 x = 144; x < 256; x++) { lengths[x] = 9; }
+		for(u32 x = 256; x < 280; x++) { lengths[x] = 7; }
+		for(u32 x = 280; x < 288; x++) { lengths[x] = 8; }
+		build(s.lit_table, lengths, 288);
+
+		for(u32 x = 0; x < 30; x++) { lengths[x] = 5; }
+		build(s.dist_table, lengths, 30);
+
+		return true;
+	}
+
+	/****** Read the codes of a dynamic block ******/
+	bool dynamic_tables(inflate_state &s)
+	{
+		u8 lengths[320];
+
+		u32 lit_count = bits(s, 5) + 257;
+		u32 dist_count = bits(s, 5) + 1;
+		u32 code_count = bits(s, 4) + 4;
+
+		if((lit_count > 286) || (dist_count > 30)) { return false; }
+
+		//Code lengths are themselves Huffman coded
+		memset(lengths, 0, 19);
+		for(u32 x = 0; x < code_count; x++) { lengths[length_order[x]] = bits(s, 3); }
+		if(!build(s.lit_table, lengths, 19)) { return false; }
+
+		u32 index = 0;
+
+		while(index < (lit_count + dist_count))
+		{
+			int symbol = decode(s, s.lit_table);
+			u32 repeat = 0;
+			u8 value = 0;
+
+			if(symbol < 0) { return false; }
+			else if(symbol < 16) { lengths[index++] = symbol; continue; }
+
+			//Repeat the last length 3 - 6 times
+			else if(symbol == 16)
+			{
+				if(index == 0) { return false; }
+				value = lengths[index - 1];
+				repeat = 3 + bits(s, 2);
+			}
+
+			//Repeat 0 for 3 - 10 or 11 - 138 times
+			else if(symbol == 17) { repeat = 3 + bits(s, 3); }
+			else { repeat = 11 + bits(s, 7); }
+
+			if((index + repeat) > (lit_count + dist_count)) { return false; }
+			while(repeat--) { lengths[index++] = value; }
+		}
+
+		//A block without an end code can't be decoded
+		if(lengths[256] == 0) { return false; }
+
+		return build(s.lit_table, lengths, lit_count) && build(s.dist_table, lengths + lit_count, dist_count);
+	}
+}
+
+/****** Decompress a raw deflate stream of input_size bytes into output ******/
+bool inflate::decompress(std::istream &input, u32 input_size, u8* output, u32 output_size, u32 &output_length)
+{
+	inflate_state s;
+
+	s.input = &input;
+	s.input_left = input_size;
+	s.chunk.resize(CHUNK_SIZE);
+	s.chunk_pos = s.chunk_end = 0;
+	s.bit_buffer = 0;
+	s.bit_count = 0;
+	s.overrun = 0;
+	s.output = output;
+	s.output_size = output_size;
+	s.output_pos = 0;
+
+	bool last_block = false;
+	bool result = true;
+
+	while((!last_block) && (result))
+	{
+		last_block = bits(s, 1);
+
+		switch(bits(s, 2))
+		{
+			case 0x0: result = stored_block(s); break;
+			case 0x1: result = fixed_tables(s) && compressed_block(s); break;
+			case 0x2: result = dynamic_tables(s) && compressed_block(s); break;
+			default: result = false; break;
+		}
+	}
+
+	output_length = s.output_pos;
+
+	//Running out of input is only an error if the padding was used
+	return (result) && ((s.overrun * 8) <= s.bit_count);
+}
+
+/****** CRC-32 used by gzip and zip ******/
+u32 inflate::crc32(const u8* data, u32 length)
+{
+	static u32 table[256];
+	static bool table_ready = false;
+
+	if(!table_ready)
+	{
+		for(u32 x = 0; x < 256; x++)
+		{
+			u32 value = x;
+			for(int bit = 0; bit < 8; bit++) { value = (value & 0x1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1); }
+			table[x] = value;
+		}
+
+		table_ready = true;
+	}
+
+	u32 crc = 0xFFFFFFFF;
+	for(u32 x = 0; x < length; x++) { crc = table[(crc ^ data[x]) & 0xFF] ^ (crc >> 8); }
+	return ~crc;
+}
@@ -0,0 +1,28 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : inflate.h
+// Date : October 17, 2026
+// Description : Deflate decompression
+//
+// Minimal decoder for raw deflate streams, as found in gzip and zip archives
+// Reads compressed data from a stream in chunks and writes straight into the output buffer
+
+#ifndef GB_INFLATE
+#define GB_INFLATE
+
+#include <istream>
+
+#include "common.h"
+
+namespace inflate
+{
+	//Compressed data is read from the stream in chunks of this size
+	const u32 CHUNK_SIZE = 0x10000;
+
+	bool decompress(std::istream &input, u32 input_size, u8* output, u32 output_size, u32 &output_length);
+	u32 crc32(const u8* data, u32 length);
+}
+
+#endif // GB_INFLATE
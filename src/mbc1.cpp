@@ -17,8 +17,8 @@ void MMU::mbc1_write(u16 address, u8 value)
 	//Write to External RAM
 	if((address >= 0xA000) && (address <= 0xBFFF) && (cart_ram))
 	{
-		if((bank_mode == 0) && (ram_banking_enabled)) { random_access_bank[0][address - 0xA000] = value; }
-		else if((bank_mode == 1) && (ram_banking_enabled)) { random_access_bank[bank_bits][address - 0xA000] = value; }
+		if((bank_mode == 0) && (ram_banking_enabled)) { random_access_bank[address - 0xA000] = value; }
+		else if((bank_mode == 1) && (ram_banking_enabled)) { random_access_bank[(bank_bits * 0x2000) + (address - 0xA000)] = value; }
 	}
 
 	//MBC register - Enable or Disable RAM Banking
@@ -40,6 +40,9 @@ void MMU::mbc1_write(u16 address, u8 value)
 
 	//MBC register - ROM/RAM Select
 	else if((address >= 0x6000) && (address <= 0x7FFF)) { bank_mode = (value & 0x1); }
+
+	//Bank changes - Update page table for reads
+	if(address <= 0x7FFF) { update_cart_pages(); }
 }
 
 /****** Performs read operations specific to the MBC1 ******/
@@ -48,30 +51,15 @@ u8 MMU::mbc1_read(u16 address)
 	//Read using ROM Banking
 	if((address >= 0x4000) && (address <= 0x7FFF))
 	{
-		u8 ext_rom_bank = ((bank_bits << 5) | rom_bank);
-
-		//Ignore top 2 bits of MBC ROM select register if ROM size is 32 banks or less
-		if(memory_map[ROM_ROMSIZE] < 0x5) { ext_rom_bank &= 0x1F; }
-
-		if((bank_mode == 0) && (ext_rom_bank >= 2)) 
-		{ 
-			return read_only_bank[ext_rom_bank - 2][address - 0x4000];
-		}
-
-		else if((bank_mode == 1) && (rom_bank >= 2)) 
-		{
-			return read_only_bank[rom_bank - 2][address - 0x4000]; 
-		}
-
-		//When reading from Banks 0-1, just use the memory map
-		else { return memory_map[address]; }
+		//The current bank is picked when the bank registers are written
+		return rom_bank_data[address - 0x4000];
 	}
 
 	//Read using RAM Banking
 	else if((address >= 0xA000) && (address <= 0xBFFF))
 	{
-		if((bank_mode == 0) && (ram_banking_enabled)) { return random_access_bank[0][address - 0xA000]; }
-		else if((bank_mode == 1) && (ram_banking_enabled)) { return random_access_bank[bank_bits][address - 0xA000]; }
+		if((bank_mode == 0) && (ram_banking_enabled)) { return random_access_bank[address - 0xA000]; }
+		else if((bank_mode == 1) && (ram_banking_enabled)) { return random_access_bank[(bank_bits * 0x2000) + (address - 0xA000)]; }
 		else { return 0x00; }
 	}
 }
\ No newline at end of file
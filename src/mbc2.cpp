@@ -18,7 +18,7 @@ void MMU::mbc2_write(u16 address, u8 value)
 	//Write to Internal RAM
 	if((address >= 0xA000) && (address <= 0xA1FF) && (ram_banking_enabled))
 	{
-		random_access_bank[0][address - 0xA000] = (value & 0xF);
+		random_access_bank[address - 0xA000] = (value & 0xF);
 	}
 
 	//MBC register - Enable or Disable RAM
@@ -35,6 +35,9 @@ void MMU::mbc2_write(u16 address, u8 value)
 	{ 	
 		if(address & 0x100) { rom_bank = (value & 0xF); }
 	}
+
+	//Bank changes - Update page table for reads
+	if(address <= 0x7FFF) { update_cart_pages(); }
 }
 
 /****** Performs read operations specific to the MBC2 ******/
@@ -43,20 +46,14 @@ u8 MMU::mbc2_read(u16 address)
 	//Read using ROM Banking
 	if((address >= 0x4000) && (address <= 0x7FFF))
 	{
-		if(rom_bank >= 2) 
-		{ 
-			return read_only_bank[rom_bank - 2][address - 0x4000];
-			std::cout<<"ROM Bank reading from : " << int(rom_bank) << "\n";
-		}
-
-		//When reading from Banks 0-1, just use the memory map
-		else { return memory_map[address]; }
+		//The current bank is picked when the bank registers are written
+		return rom_bank_data[address - 0x4000];
 	}
 
 	//Read from Internal RAM
 	else if((address >= 0xA000) && (address <= 0xA1FF))
 	{
-		if(ram_banking_enabled) { return (random_access_bank[0][address - 0xA000] & 0xF); }
+		if(ram_banking_enabled) { return (random_access_bank[address - 0xA000] & 0xF); }
 		else { return 0x00; }
 	}
 
@@ -45,7 +45,7 @@ void MMU::mbc3_write(u16 address, u8 value)
 	//Write to External RAM or RTC register
 	if((address >= 0xA000) && (address <= 0xBFFF))
 	{
-		if((ram_banking_enabled) && (bank_bits <= 3)) { random_access_bank[bank_bits][address - 0xA000] = value; }
+		if((ram_banking_enabled) && (bank_bits <= 3)) { random_access_bank[(bank_bits * 0x2000) + (address - 0xA000)] = value; }
 		else if((rtc_enabled) && (bank_bits >= 0x8) && (bank_bits <= 0xC)) { rtc_reg[bank_bits - 8] = value; }
 	}
 
@@ -90,6 +90,9 @@ void MMU::mbc3_write(u16 address, u8 value)
 			}
 		}
 	}	
+
+	//Bank changes - Update page table for reads
+	if(address <= 0x7FFF) { update_cart_pages(); }
 }
 
 /****** Performs write operations specific to the MBC3 ******/
@@ -98,19 +101,14 @@ u8 MMU::mbc3_read(u16 address)
 	//Read using ROM Banking
 	if((address >= 0x4000) && (address <= 0x7FFF))
 	{
-		if(rom_bank >= 2) 
-		{ 
-			return read_only_bank[rom_bank - 2][address - 0x4000];
-		}
-
-		//When reading from Banks 0-1, just use the memory map
-		else { return memory_map[address]; }
+		//The current bank is picked when the bank registers are written
+		return rom_bank_data[address - 0x4000];
 	}
 
 	//Read using RAM Banking or RTC regs
 	else if((address >= 0xA000) && (address <= 0xBFFF))
 	{
-		if((ram_banking_enabled) && (bank_bits <= 3)) { return random_access_bank[bank_bits][address - 0xA000]; }
+		if((ram_banking_enabled) && (bank_bits <= 3)) { return random_access_bank[(bank_bits * 0x2000) + (address - 0xA000)]; }
 		else if((rtc_enabled) && (bank_bits >= 0x8) && (bank_bits <= 0xC)) { return rtc_reg[bank_bits - 8]; }
 		else { return 0x00; }
 	}
@@ -18,7 +18,7 @@ void MMU::mbc5_write(u16 address, u8 value)
 	//Write to External RAM or RTC register
 	if((address >= 0xA000) && (address <= 0xBFFF))
 	{
-		if(ram_banking_enabled) { random_access_bank[bank_bits][address - 0xA000] = value; }
+		if(ram_banking_enabled) { random_access_bank[(bank_bits * 0x2000) + (address - 0xA000)] = value; }
 	}
 
 	//MBC register - Enable or Disable RAM Banking
@@ -60,6 +60,9 @@ void MMU::mbc5_write(u16 address, u8 value)
 		//Nintendo specifically says to avoid it though (nice one Capcom...)
 		if(memory_map[ROM_RAMSIZE] <= 2) { bank_bits = 0; }
 	}
+
+	//Bank changes - Update page table for reads
+	if(address <= 0x7FFF) { update_cart_pages(); }
 }
 
 /****** Performs write operations specific to the MBC5 ******/
@@ -68,19 +71,14 @@ u8 MMU::mbc5_read(u16 address)
 	//Read using ROM Banking
 	if((address >= 0x4000) && (address <= 0x7FFF))
 	{
-		if(rom_bank >= 2) 
-		{ 
-			return read_only_bank[rom_bank - 2][address - 0x4000];
-		}
-
-		//When reading from Banks 0-1, just use the memory map
-		else { return memory_map[address]; }
+		//The current bank is picked when the bank registers are written
+		return rom_bank_data[address - 0x4000];
 	}
 
 	//Read using RAM Banking
 	else if((address >= 0xA000) && (address <= 0xBFFF))
 	{
-		if(ram_banking_enabled) { return random_access_bank[bank_bits][address - 0xA000]; }
+		if(ram_banking_enabled) { return random_access_bank[(bank_bits * 0x2000) + (address - 0xA000)]; }
 		else { return 0x00; }
 	}
 }
\ No newline at end of file
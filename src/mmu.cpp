@@ -13,6 +13,9 @@
 /****** GameBoy Memory Manager Unit ******/ 
 
 #include "mmu.h"
+#include "bench.h"
+#include "savestate.h"
+#include "scheduler.h"
 #include <iostream>
 #include <ctime>
 
@@ -31,6 +34,12 @@ MMU::MMU()
 	gpu_hdma_current_line = 0;
 	gpu_update_sprite_colors = false;
 	gpu_update_bg_colors = false;
+	gpu_update_bgp = false;
+	memset(gpu_dirty_tiles, 0, sizeof(gpu_dirty_tiles));
+
+	memset(cpu_code_chunk, 0, sizeof(cpu_code_chunk));
+	cpu_dirty_code = false;
+	cpu_update_blocks = false;
 
 	apu_update_channel = false;
 	apu_update_addr = 0;
@@ -45,6 +54,8 @@ MMU::MMU()
 	rtc_enabled = false;
 	rtc_latch_1 = rtc_latch_2 = 0xFF;
 
+	timers.interrupt_flag = &memory_map[REG_IF];
+
 	rom_bank = 1;
 	ram_bank = 0;
 	wram_bank = 1;
@@ -55,17 +66,16 @@ MMU::MMU()
 
 	save_ram_file = "";
 
-	read_only_bank.resize(0x200);
-	for(int x = 0; x < 0x200; x++) { read_only_bank[x].resize(0x4000, 0); }
+	rom_bank_data = memory_map + 0x4000;
 
-	random_access_bank.resize(0x10);
-	for(int x = 0; x < 0x10; x++) { random_access_bank[x].resize(0x2000, 0); }
+	//16 8KB Cartridge RAM banks, 8 4KB Working RAM banks, then 2 8KB VRAM banks - Padded to start on a 64 byte cache line
+	bank_arena.resize(0x20000 + 0x8000 + 0x4000 + 63, 0);
+	random_access_bank = &bank_arena[(64 - ((size_t)&bank_arena[0] & 63)) & 63];
+	working_ram_bank = random_access_bank + 0x20000;
+	video_ram = working_ram_bank + 0x8000;
 
-	working_ram_bank.resize(0x8);
-	for(int x = 0; x < 0x8; x++) { working_ram_bank[x].resize(0x1000, 0); }
-
-	video_ram.resize(0x2);
-	for(int x = 0; x < 0x2; x++) { video_ram[x].resize(0x2000, 0); }
+	memset(write_page, 0, sizeof(write_page));
+	update_read_pages();
 }
 
 /****** MMU Deconstructor ******/
@@ -74,6 +84,12 @@ MMU::~MMU() { }
 /****** Read byte from memory ******/
 u8 MMU::read_byte(u16 address) 
 { 
+	bench_scope timer(bench::MMU_READ);
+
+	//Plain memory is read directly through the page table
+	u8* page = read_page[address >> 8];
+	if(page != NULL) { return page[address & 0xFF]; }
+
 	//Read from BIOS
 	if(in_bios)
 	{
@@ -89,6 +105,8 @@ u8 MMU::read_byte(u16 address)
 
 			//For DMG on GBC games, we switch back to DMG Mode (we just take the colors the BIOS gives us)
 			if((bios_size == 0x900) && (memory_map[ROM_COLOR] == 0)) { config::gb_type = 1; }
+
+			update_read_pages();
 		}
 
 		else if(address < bios_size) { return bios[address]; }
@@ -110,20 +128,20 @@ u8 MMU::read_byte(u16 address)
 	if((address >= 0x8000) && (address <= 0x9FFF))
 	{
 		//GBC read from VRAM Bank 1
-		if((vram_bank == 1) && (config::gb_type == 2)) { return video_ram[1][address-0x8000]; }
+		if((vram_bank == 1) && (config::gb_type == 2)) { return video_ram[0x2000 + (address-0x8000)]; }
 		
 		//GBC read from VRAM Bank 0 - DMG read normally, also from Bank 0, though it doesn't use banking technically
-		else { return video_ram[0][address-0x8000]; }
+		else { return video_ram[address-0x8000]; }
 	}
 
 	//In GBC mode, read from Working RAM using Banking
 	if((address >= 0xC000) && (address <= 0xDFFF) && (config::gb_type == 2)) 
 	{
 		//Read from Bank 0 always when address is within 0xC000 - 0xCFFF
-		if((address >= 0xC000) && (address <= 0xCFFF)) { return working_ram_bank[0][address-0xC000]; }
+		if((address >= 0xC000) && (address <= 0xCFFF)) { return working_ram_bank[address-0xC000]; }
 			
 		//Read from selected Bank when address is within 0xD000 - 0xDFFF
-		else if((address >= 0xD000) && (address <= 0xDFFF)) { return working_ram_bank[wram_bank][address-0xD000]; }
+		else if((address >= 0xD000) && (address <= 0xDFFF)) { return working_ram_bank[(wram_bank * 0x1000) + (address-0xD000)]; }
 	}
 
 	//Read background color palette data
@@ -170,6 +188,9 @@ u8 MMU::read_byte(u16 address)
 	//Read from P1
 	else if(address == 0xFF00) { return pad.read(); }
 
+	//Read DIV, TIMA, TMA, and TAC - Worked out from the cycle count
+	else if((address >= REG_DIV) && (address <= REG_TAC)) { return timers.read(address); }
+
 	//Read normally
 	return memory_map[address]; 
 
@@ -194,22 +215,35 @@ u16 MMU::read_word(u16 address)
 /****** Write Byte To Memory ******/
 void MMU::write_byte(u16 address, u8 value) 
 {
+	bench_scope timer(bench::MMU_WRITE);
+
 	if(mbc_type != ROM_ONLY) { mbc_write(address, value); }
 
+	//Writes to MBC registers can swap ROM banks, so stop running the CPU's current decoded block
+	if(address <= 0x7FFF) { cpu_update_blocks = true; }
+
+	//Writes to RAM holding decoded code - Echo RAM mirrors Internal RAM, so check both
+	if(cpu_code_chunk[address >> 6]) { cpu_code_chunk[address >> 6] = 2; cpu_dirty_code = cpu_update_blocks = true; }
+
+	if(((address >= 0xC000) && (address <= 0xDDFF)) || ((address >= 0xE000) && (address <= 0xFDFF)))
+	{
+		u16 mirror_address = (address >= 0xE000) ? (address - 0x2000) : (address + 0x2000);
+		if(cpu_code_chunk[mirror_address >> 6]) { cpu_code_chunk[mirror_address >> 6] = 2; cpu_dirty_code = cpu_update_blocks = true; }
+	}
+
 	//Read from VRAM, GBC uses banking
 	if((address >= 0x8000) && (address <= 0x9FFF))
 	{
-		//GBC read from VRAM Bank 1
-		if((vram_bank == 1) && (config::gb_type == 2)) { video_ram[1][address-0x8000] = value; }
-		
-		//GBC read from VRAM Bank 0 - DMG read normally, also from Bank 0, though it doesn't use banking technically
-		else { video_ram[0][address-0x8000] = value; }
+		//GBC read from VRAM Bank 1 - DMG read normally, also from Bank 0, though it doesn't use banking technically
+		u8 bank = ((vram_bank == 1) && (config::gb_type == 2)) ? 1 : 0;
+		video_ram[(bank * 0x2000) + (address-0x8000)] = value;
 
-		//VRAM - Background tiles update
+		//VRAM - Background tiles update, mark the tile as dirty
 		if((address >= 0x8000) && (address <= 0x97FF))
 		{
+			u16 tile_number = (address - 0x8000) >> 4;
+			gpu_dirty_tiles[bank][tile_number >> 5] |= (1 << (tile_number & 0x1F));
 			gpu_update_bg_tile = true;
-			gpu_update_addr.push_back(address);
 			if(address <= 0x8FFF) { gpu_update_sprite = true; }
 		}
 	}	
@@ -218,7 +252,7 @@ void MMU::write_byte(u16 address, u8 value)
 	else if(address == REG_BGP)
 	{
 		gpu_update_bg_tile = true;
-		gpu_update_addr.push_back(address);
+		gpu_update_bgp = true;
 		memory_map[address] = value;
 	}
 
@@ -245,8 +279,21 @@ void MMU::write_byte(u16 address, u8 value)
 		if(current_bit != new_bit) { gpu_update_sprite = true; }
 
 		memory_map[address] = value;
+
+		//The GPU turns the LCD on and off right away
+		scheduler::request_event();
+	}
+
+	//STAT - The GPU puts the current mode back in the lower bits right away
+	else if(address == REG_STAT)
+	{
+		memory_map[address] = value;
+		scheduler::request_event();
 	}
 
+	//DIV, TIMA, TMA, and TAC
+	else if((address >= REG_DIV) && (address <= REG_TAC)) { timers.write(address, value); }
+
 	//DMA transfer
 	else if(address == REG_DMA) 
 	{
@@ -270,10 +317,10 @@ void MMU::write_byte(u16 address, u8 value)
 		else if(config::gb_type == 2)
 		{
 			//Write to Bank 0 always when address is within 0xC000 - 0xCFFF
-			if((address >= 0xC000) && (address <= 0xCFFF)) { working_ram_bank[0][address-0xC000] = value; }
+			if((address >= 0xC000) && (address <= 0xCFFF)) { working_ram_bank[address-0xC000] = value; }
 			
 			//Write to selected Bank when address is within 0xD000 - 0xDFFF
-			else if((address >= 0xD000) && (address <= 0xDFFF)) { working_ram_bank[wram_bank][address-0xD000] = value; }
+			else if((address >= 0xD000) && (address <= 0xDFFF)) { working_ram_bank[(wram_bank * 0x1000) + (address-0xD000)] = value; }
 		}
 	}
 
@@ -300,6 +347,7 @@ void MMU::write_byte(u16 address, u8 value)
 		memory_map[address] = value;
 		apu_update_channel = true; 
 		apu_update_addr = address; 
+		scheduler::request_event();
 	}
 
 	//HDMA transfer
@@ -323,6 +371,7 @@ void MMU::write_byte(u16 address, u8 value)
 		}
 
 		memory_map[address] = value;
+		scheduler::request_event();
 	}
 
 	//NR52
@@ -340,6 +389,7 @@ void MMU::write_byte(u16 address, u8 value)
 	{ 
 		vram_bank = value & 0x1; 
 		memory_map[address] = value; 
+		update_read_pages();
 	}
 
 	//KEY1 - Double-Normal speed switch
@@ -355,6 +405,7 @@ void MMU::write_byte(u16 address, u8 value)
 	{
 		gpu_update_bg_colors = true;
 		memory_map[address] = value;
+		scheduler::request_event();
 	}
 
 	//OCPD - Update sprite color palettes
@@ -362,6 +413,7 @@ void MMU::write_byte(u16 address, u8 value)
 	{
 		gpu_update_sprite_colors = true;
 		memory_map[address] = value;
+		scheduler::request_event();
 	}
 
 	//SVBK - Update Working RAM bank
@@ -370,6 +422,8 @@ void MMU::write_byte(u16 address, u8 value)
 		wram_bank = value & 0x7;
 		if(wram_bank == 0) { wram_bank = 1; }
 		memory_map[address] = value;
+		cpu_update_blocks = true;
+		update_read_pages();
 	}
 
 	else if(address > 0x7FFF) { memory_map[address] = value; }
@@ -382,6 +436,108 @@ void MMU::write_word(u16 address, u16 value)
 	write_byte((address+1), (value >> 8));
 }
 
+/****** Point a range of pages in the read page table to host memory ******/
+void MMU::map_pages(u16 address, u16 size, u8* data)
+{
+	for(u32 x = 0; x < size; x += 0x100) { read_page[(address + x) >> 8] = (data != NULL) ? (data + x) : NULL; }
+}
+
+/****** Point a range of pages in the write page table to host memory ******/
+void MMU::map_write_pages(u16 address, u16 size, u8* data)
+{
+	for(u32 x = 0; x < size; x += 0x100) { write_page[(address + x) >> 8] = data + x; }
+}
+
+/****** Rebuild the read page table ******/
+void MMU::update_read_pages()
+{
+	//ROM Bank 0, OAM, Echo RAM
+	map_pages(0x0000, 0x4000, memory_map);
+	map_pages(0xE000, 0x1F00, memory_map + 0xE000);
+
+	//BIOS is handled by the slow path until it exits
+	if(in_bios) { map_pages(0x0000, 0x900, NULL); }
+
+	//VRAM
+	if((vram_bank == 1) && (config::gb_type == 2)) { map_pages(0x8000, 0x2000, &video_ram[0x2000]); }
+	else { map_pages(0x8000, 0x2000, video_ram); }
+
+	//Working RAM - GBC uses banking
+	if(config::gb_type == 2)
+	{
+		map_pages(0xC000, 0x1000, working_ram_bank);
+		map_pages(0xD000, 0x1000, &working_ram_bank[wram_bank * 0x1000]);
+		map_write_pages(0xC000, 0x1000, working_ram_bank);
+		map_write_pages(0xD000, 0x1000, &working_ram_bank[wram_bank * 0x1000]);
+	}
+
+	//DMG writes are mirrored into Echo RAM as well, the JIT does that itself
+	else
+	{
+		map_pages(0xC000, 0x2000, memory_map + 0xC000);
+		map_write_pages(0xC000, 0x2000, memory_map + 0xC000);
+	}
+
+	//MMIO and HRAM
+	map_pages(0xFF00, 0x100, NULL);
+
+	update_cart_pages();
+}
+
+/****** Rebuild the read page table for ROM and RAM banks ******/
+void MMU::update_cart_pages()
+{
+	u8* rom = memory_map + 0x4000;
+	u8* ram = memory_map + 0xA000;
+
+	switch(mbc_type)
+	{
+		case MBC1:
+			{
+				u8 ext_rom_bank = ((bank_bits << 5) | rom_bank);
+				if(memory_map[ROM_ROMSIZE] < 0x5) { ext_rom_bank &= 0x1F; }
+
+				rom = rom_bank_pointer((bank_mode == 0) ? ext_rom_bank : rom_bank);
+
+				if((cart_ram) && (ram_banking_enabled)) { ram = (bank_mode == 0) ? random_access_bank : &random_access_bank[bank_bits * 0x2000]; }
+				else if(cart_ram) { ram = NULL; }
+			}
+			break;
+
+		//MBC2 RAM only holds 4-bit values, always use the slow path
+		case MBC2:
+			rom = rom_bank_pointer(rom_bank);
+			ram = NULL;
+			break;
+
+		case MBC3:
+			rom = rom_bank_pointer(rom_bank);
+			if((cart_ram) && (ram_banking_enabled) && (bank_bits <= 3)) { ram = &random_access_bank[bank_bits * 0x2000]; }
+			else if(cart_ram) { ram = NULL; }
+			break;
+
+		case MBC5:
+			rom = rom_bank_pointer(rom_bank);
+			if((cart_ram) && (ram_banking_enabled)) { ram = &random_access_bank[bank_bits * 0x2000]; }
+			else if(cart_ram) { ram = NULL; }
+			break;
+
+		//ROM only carts never switch banks, they read straight from the memory map
+		case ROM_ONLY: break;
+	}
+
+	rom_bank_data = rom;
+	map_pages(0x4000, 0x4000, rom);
+	map_pages(0xA000, 0x2000, ram);
+}
+
+/****** Pointer to a switchable ROM bank - Banks 0 and 1 read from the memory map ******/
+u8* MMU::rom_bank_pointer(u16 bank)
+{
+	if((bank < 2) || (rom_file.data == NULL)) { return memory_map + 0x4000; }
+	return rom_file.bank(bank);
+}
+
 /****** Determines which if any MBC to read from ******/
 u8 MMU::mbc_read(u16 address)
 {
@@ -433,16 +589,11 @@ bool MMU::read_file(std::string filename)
 {
 	memset(memory_map, 0, sizeof(memory_map));
 
-	std::ifstream file(filename.c_str(), std::ios::binary);
-
-	if(!file.is_open()) 
-	{
-		std::cout<<"MMU : " << filename << " could not be opened. Check file path or permissions. \n";
-		return false;
-	}
+	//Map or decompress the whole ROM
+	if(!rom_file.load(filename)) { return false; }
 
-	//Read 32KB worth of data from ROM file
-	file.read((char*)memory_map, 0x8000);
+	//Copy 32KB worth of data from the ROM
+	memcpy(memory_map, rom_file.data, 0x8000);
 
 	//Manually HLE MMIO
 	if(!in_bios) 
@@ -452,8 +603,7 @@ bool MMU::read_file(std::string filename)
 		memory_map[REG_OBP0] = 0xFF;
 		memory_map[REG_OBP1] = 0xFF;
 		memory_map[REG_P1] = 0xFF;
-		memory_map[REG_DIV] = 0xAF;
-		memory_map[REG_TAC] = 0xF8;
+		timers.reset(0xAF00);
 		memory_map[0xFF10] = 0x80;
 		memory_map[0xFF11] = 0xBF;
    		memory_map[0xFF12] = 0xF3; 
@@ -630,22 +780,9 @@ bool MMU::read_file(std::string filename)
 			return false;
 	}
 
-	//Read additional ROM data to banks
-	if(mbc_type != ROM_ONLY)
-	{
-		//Use a file positioner
-		u32 file_pos = 0x8000;
-		u8 bank_count = 0;
-
-		while(file_pos < (cart_rom_size * 1024))
-		{
-			file.read(reinterpret_cast<char*> (&read_only_bank[bank_count][0]), 0x4000);
-			file_pos += 0x4000;
-			bank_count++;
-		}
-	}
+	//Banks past the end of the file read as 0 - Bank switches only swap pointers into the ROM
+	if(mbc_type != ROM_ONLY) { rom_file.fit(cart_rom_size * 1024); }
 
-	file.close();
 	std::cout<<"MMU : " << filename << " loaded successfully. \n"; 
 
 	//Load Saved RAM if available
@@ -658,10 +795,7 @@ bool MMU::read_file(std::string filename)
 
 		else 
 		{
-			for(int x = 0; x < 0x10; x++)
-			{
-				sram.read(reinterpret_cast<char*> (&random_access_bank[x][0]), 0x2000); 
-			}
+			sram.read(reinterpret_cast<char*> (random_access_bank), 0x20000); 
 		}
 
 		sram.close();
@@ -678,6 +812,8 @@ bool MMU::read_file(std::string filename)
 		else if((memory_map[ROM_COLOR] == 0xC0) && (config::gb_type == 0)) { config::gb_type = 2; }
 	}
 
+	update_read_pages();
+
 	return true;
 }
 
@@ -731,13 +867,118 @@ void MMU::save_sram()
 
 		else 
 		{
-			for(int x = 0; x < 0x10; x++)
-			{
-				sram.write(reinterpret_cast<char*> (&random_access_bank[x][0]), 0x2000); 
-			}
+			sram.write(reinterpret_cast<char*> (random_access_bank), 0x20000); 
 
 			sram.close();
 			std::cout<<"MMU :  " << save_ram_file << " battery file saved.\n";
 		}
 	}
-}
\ No newline at end of file
+}
+/****** Number of cartridge RAM banks stored in save states ******/
+u8 MMU::state_ram_banks()
+{
+	if(!cart_ram) { return 0; }
+
+	switch(memory_map[ROM_RAMSIZE])
+	{
+		case 0x00:
+		case 0x01:
+		case 0x02: return 1;
+		case 0x03: return 4;
+		case 0x05: return 8;
+		default: return 0x10;
+	}
+}
+
+/****** Save MMU state ******/
+void MMU::save_state(std::vector<u8> &state)
+{
+	//An overflowing TIMA may still have to raise its interrupt in IF
+	timers.update();
+
+	//Everything below 0x8000 is ROM, which never changes
+	savestate::write(state, &memory_map[0x8000], 0x8000);
+
+	u8 ram_banks = state_ram_banks();
+	savestate::write(state, ram_banks);
+	savestate::write(state, random_access_bank, ram_banks * 0x2000);
+
+	//Working RAM and VRAM follow each other in the arena
+	savestate::write(state, working_ram_bank, 0x8000 + 0x4000);
+
+	savestate::write(state, rom_bank);
+	savestate::write(state, ram_bank);
+	savestate::write(state, wram_bank);
+	savestate::write(state, vram_bank);
+	savestate::write(state, bank_bits);
+	savestate::write(state, bank_mode);
+	savestate::write(state, ram_banking_enabled);
+	savestate::write(state, in_bios);
+
+	savestate::write(state, sprite_colors_raw);
+	savestate::write(state, background_colors_raw);
+	savestate::write(state, pad.column_id);
+
+	savestate::write(state, rtc_latch_1);
+	savestate::write(state, rtc_latch_2);
+	savestate::write(state, rtc_reg);
+	savestate::write(state, rtc_enabled);
+
+	savestate::write(state, gpu_update_sprite);
+	savestate::write(state, gpu_reset_ticks);
+	savestate::write(state, gpu_hdma_in_progress);
+	savestate::write(state, gpu_hdma_type);
+	savestate::write(state, gpu_hdma_current_line);
+	savestate::write(state, gpu_update_sprite_colors);
+	savestate::write(state, gpu_update_bg_colors);
+	savestate::write(state, gpu_update_bgp);
+
+	savestate::write(state, apu_update_channel);
+	savestate::write(state, apu_update_addr);
+
+	timers.save_state(state);
+}
+
+/****** Load MMU state ******/
+bool MMU::load_state(const std::vector<u8> &state, u32 &offset)
+{
+	u8 ram_banks = 0;
+
+	if(!savestate::read(state, offset, &memory_map[0x8000], 0x8000)) { return false; }
+	if(!savestate::read(state, offset, ram_banks) || (ram_banks != state_ram_banks())) { return false; }
+
+	if(!savestate::read(state, offset, random_access_bank, ram_banks * 0x2000)) { return false; }
+	if(!savestate::read(state, offset, working_ram_bank, 0x8000 + 0x4000)) { return false; }
+
+	bool result = savestate::read(state, offset, rom_bank)
+	&& savestate::read(state, offset, ram_bank)
+	&& savestate::read(state, offset, wram_bank)
+	&& savestate::read(state, offset, vram_bank)
+	&& savestate::read(state, offset, bank_bits)
+	&& savestate::read(state, offset, bank_mode)
+	&& savestate::read(state, offset, ram_banking_enabled)
+	&& savestate::read(state, offset, in_bios)
+	&& savestate::read(state, offset, sprite_colors_raw)
+	&& savestate::read(state, offset, background_colors_raw)
+	&& savestate::read(state, offset, pad.column_id)
+	&& savestate::read(state, offset, rtc_latch_1)
+	&& savestate::read(state, offset, rtc_latch_2)
+	&& savestate::read(state, offset, rtc_reg)
+	&& savestate::read(state, offset, rtc_enabled)
+	&& savestate::read(state, offset, gpu_update_sprite)
+	&& savestate::read(state, offset, gpu_reset_ticks)
+	&& savestate::read(state, offset, gpu_hdma_in_progress)
+	&& savestate::read(state, offset, gpu_hdma_type)
+	&& savestate::read(state, offset, gpu_hdma_current_line)
+	&& savestate::read(state, offset, gpu_update_sprite_colors)
+	&& savestate::read(state, offset, gpu_update_bg_colors)
+	&& savestate::read(state, offset, gpu_update_bgp)
+	&& savestate::read(state, offset, apu_update_channel)
+	&& savestate::read(state, offset, apu_update_addr)
+	&& timers.load_state(state, offset);
+
+	//Banks may have changed, rebuild the page table
+	update_read_pages();
+
+	return result;
+}
@@ -20,6 +20,8 @@
 
 #include "common.h"
 #include "gamepad.h"
+#include "timer.h"
+#include "rom_file.h"
 
 class MMU
 {
@@ -29,14 +31,26 @@ class MMU
 	u8 memory_map[0x10000];
 	u8 bios [0x900];
 
-	//Memory Banks
-	std::vector< std::vector<u8> > read_only_bank;
-	std::vector< std::vector<u8> > random_access_bank;
+	//Memory Banks - Cartridge RAM, Working RAM, and VRAM share one contiguous, cache-aligned arena
+	//Each region holds its banks back to back, so bank N starts at N times the bank size
+	std::vector<u8> bank_arena;
+	u8* random_access_bank;
 
 	//Working RAM Banks - GBC only
-	std::vector< std::vector<u8> > working_ram_bank;
+	u8* working_ram_bank;
 
-	std::vector< std::vector<u8> > video_ram;
+	u8* video_ram;
+
+	//Cartridge ROM and the switchable bank at 0x4000 - 0x7FFF, which points into it
+	ROMFile rom_file;
+	u8* rom_bank_data;
+
+	//Page table for reads - 256 pages of 256 bytes each
+	//NULL pages (BIOS, banked areas with special behavior, MMIO) take the slow path
+	u8* read_page[0x100];
+
+	//Page table for writes that are plain stores, used by the JIT - Only Working RAM, everything else takes write_byte()
+	u8* write_page[0x100];
 
 	u16 rom_bank;
 	u8 ram_bank;
@@ -50,6 +64,7 @@ class MMU
 	u16 background_colors_raw[4][8];
 
 	GamePad pad;
+	Timer timers;
 
 	bool in_bios;
 	u8 bios_type;
@@ -66,12 +81,23 @@ class MMU
 	void write_byte(u16 address, u8 value);
 	void write_word(u16 address, u16 value);
 
+	void update_read_pages();
+	void update_cart_pages();
+	void map_pages(u16 address, u16 size, u8* data);
+	void map_write_pages(u16 address, u16 size, u8* data);
+	u8* rom_bank_pointer(u16 bank);
+
 	bool read_file(std::string filename);
 	bool read_bios(std::string filename);
 
 	void save_sram();
 	void grab_time();
 
+	//Save states
+	void save_state(std::vector<u8> &state);
+	bool load_state(const std::vector<u8> &state, u32 &offset);
+	u8 state_ram_banks();
+
 	//Memory Bank Controller dedicated read/write operations
 	void mbc_write(u16 address, u8 value);
 	u8 mbc_read(u16 address);
@@ -107,7 +133,16 @@ class MMU
 	u8 gpu_hdma_current_line;
 	bool gpu_update_sprite_colors;
 	bool gpu_update_bg_colors;
-	std::vector<u16> gpu_update_addr;
+	bool gpu_update_bgp;
+
+	//Tiles written to since the GPU last decoded them - 384 tiles per VRAM bank, 1 bit each
+	u32 gpu_dirty_tiles[2][12];
+
+	//Variables read by the CPU
+	//Tracks which 64-byte chunks of RAM hold decoded code - 0 = None, 1 = Cached, 2 = Cached + Written to
+	u8 cpu_code_chunk[0x400];
+	bool cpu_dirty_code;
+	bool cpu_update_blocks;
 
 	//Variables read by the APU
 	//TODO: Extern these into a separate namespace
@@ -0,0 +1,152 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : present.cpp
+// Date : October 17, 2026
+// Description : Frame presenter thread
+//
+// Scales, blits and flips finished frames on their own thread
+// Frames are passed from the emulation through a lock-free triple buffer
+
+#include "gpu.h"
+#include "filter.h"
+#include "hotkeys.h"
+
+/****** Presenter thread entry point ******/
+static int presenter_main(void* data)
+{
+	GPU* gb_gpu = reinterpret_cast<GPU*>(data);
+	gb_gpu->presenter_loop();
+	return 0;
+}
+
+/****** Initialize the screen - Accounts for scaling, fullscreen and OpenGL ******/
+void GPU::init_screen()
+{
+	if((!config::use_scaling) && (!config::use_opengl)) 
+	{ 
+		gpu_screen = SDL_SetVideoMode(160, 144, 32, SDL_SWSURFACE | config::flags); 
+	}
+	
+	else if((config::use_scaling) && (!config::use_opengl)) 
+	{ 
+		gpu_screen = SDL_SetVideoMode((160 * config::scaling_factor), (144 * config::scaling_factor), 32, SDL_SWSURFACE | config::flags); 
+	}
+	
+	else if(config::use_opengl) { opengl_init(); }
+
+	SDL_WM_SetCaption("GBE", NULL);
+}
+
+/****** Start the presenter thread - It takes over the screen and SDL event pumping ******/
+bool GPU::start_presenter()
+{
+	for(int x = 0; x < 3; x++)
+	{
+		frame_surfaces[x] = SDL_CreateRGBSurface(SDL_SWSURFACE, 160, 144, 32, 0, 0, 0, 0);
+		if(frame_surfaces[x] == NULL) { stop_presenter(); return false; }
+	}
+
+	back_buffer = 0;
+	front_buffer = 1;
+	ready_buffer = 2;
+
+	frame_ready = SDL_CreateSemaphore(0);
+	screen_ready = SDL_CreateSemaphore(0);
+	presenter_running = true;
+
+	if((frame_ready == NULL) || (screen_ready == NULL)) { stop_presenter(); return false; }
+
+	presenter = SDL_CreateThread(presenter_main, this);
+
+	if(presenter == NULL)
+	{
+		std::cout<<"GPU : Could not start presenter thread\n";
+		stop_presenter();
+		return false;
+	}
+
+	//The screen has to exist before the emulation starts
+	SDL_SemWait(screen_ready);
+	return true;
+}
+
+/****** Stop the presenter thread and free its buffers ******/
+void GPU::stop_presenter()
+{
+	presenter_running = false;
+
+	if(presenter != NULL)
+	{
+		SDL_SemPost(frame_ready);
+		SDL_WaitThread(presenter, NULL);
+		presenter = NULL;
+	}
+
+	if(frame_ready != NULL) { SDL_DestroySemaphore(frame_ready); frame_ready = NULL; }
+	if(screen_ready != NULL) { SDL_DestroySemaphore(screen_ready); screen_ready = NULL; }
+
+	for(int x = 0; x < 3; x++)
+	{
+		if(frame_surfaces[x] != NULL) { SDL_FreeSurface(frame_surfaces[x]); frame_surfaces[x] = NULL; }
+	}
+}
+
+/****** Publish the finished back buffer - Never waits on the presenter ******/
+void GPU::publish_frame()
+{
+	//Swap the back buffer with the middle one - A frame the presenter hasn't taken yet is simply replaced
+	back_buffer = ready_buffer.exchange(back_buffer | READY_NEW) & 0x3;
+	SDL_SemPost(frame_ready);
+}
+
+/****** Scale and blit a finished frame to the screen ******/
+void GPU::present_frame(SDL_Surface* frame)
+{
+	//Scale the source image...
+	if((config::use_scaling) && (!config::use_opengl)) 
+	{
+		apply_scaling(frame, temp_screen);
+		SDL_BlitSurface(temp_screen, 0, gpu_screen, 0);
+	}
+	
+	//Or just blit to unscaled image to screen
+	else { SDL_BlitSurface(frame, 0, gpu_screen, 0); }
+
+	//Blit via SDL
+	if(!config::use_opengl)
+	{
+		if(SDL_Flip(gpu_screen) == -1) { std::cout<<"Could not blit? \n"; }
+	}
+
+	//Blit via OpenGL
+	else { opengl_blit(); }
+}
+
+/****** Presenter thread - Shows the newest frame and keeps SDL events flowing ******/
+void GPU::presenter_loop()
+{
+	//SDL 1.2 expects the thread that set the video mode to blit and pump events
+	init_screen();
+	SDL_SemPost(screen_ready);
+
+	while(presenter_running)
+	{
+		//Wake up for each new frame, or regularly so input is handled while no frames come in
+		SDL_SemWaitTimeout(frame_ready, 10);
+		SDL_PumpEvents();
+
+		//Switch between fullscreen and windowed mode
+		if(screen_reset_request.exchange(false)) { init_screen(); }
+
+		//Swap the front buffer with the middle one if it holds a new frame
+		if(ready_buffer.load() & READY_NEW)
+		{
+			front_buffer = ready_buffer.exchange(front_buffer) & 0x3;
+			present_frame(frame_surfaces[front_buffer]);
+		}
+
+		if(screenshot_request.exchange(false)) { take_screenshot(*this); }
+	}
+}
@@ -0,0 +1,125 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : render_worker.cpp
+// Date : October 17, 2026
+// Description : Scanline render worker thread
+//
+// Draws scanlines on a second core while the CPU emulates the next line
+// Each line works from registers and tile map rows captured when it was queued
+
+#include <thread>
+
+#include "gpu.h"
+
+//Checks for a new line before the worker goes to sleep, or for a finished line before the CPU yields
+//Lines arrive every few microseconds in turbo mode
+const u32 WORKER_SPIN_COUNT = 4096;
+
+/****** Render worker entry point ******/
+static int render_worker_main(void* data)
+{
+	GPU* gb_gpu = reinterpret_cast<GPU*>(data);
+	gb_gpu->render_worker_loop();
+	return 0;
+}
+
+/****** Start the render worker - Not used with custom graphics, which draw tiles while dumping and loading ******/
+bool GPU::start_render_worker()
+{
+	if((config::dump_sprites) || (config::load_sprites)) { return false; }
+
+	//With a single core, the CPU and the worker would only take turns
+	if(std::thread::hardware_concurrency() == 1)
+	{
+		std::cout<<"GPU : Render worker needs more than one CPU core\n";
+		return false;
+	}
+
+	worker_wakeup = SDL_CreateSemaphore(0);
+	if(worker_wakeup == NULL) { return false; }
+
+	line_queued = false;
+	worker_sleeping = false;
+	worker_running = true;
+
+	render_worker = SDL_CreateThread(render_worker_main, this);
+
+	if(render_worker == NULL)
+	{
+		std::cout<<"GPU : Could not start render worker thread\n";
+		stop_render_worker();
+		return false;
+	}
+
+	return true;
+}
+
+/****** Stop the render worker - Finishes the line in flight first ******/
+void GPU::stop_render_worker()
+{
+	if(render_worker != NULL)
+	{
+		finish_scanline();
+
+		worker_running = false;
+		SDL_SemPost(worker_wakeup);
+		SDL_WaitThread(render_worker, NULL);
+		render_worker = NULL;
+	}
+
+	if(worker_wakeup != NULL) { SDL_DestroySemaphore(worker_wakeup); worker_wakeup = NULL; }
+}
+
+/****** Hand the captured scanline to the render worker ******/
+void GPU::queue_scanline()
+{
+	line_queued = true;
+
+	//Only pay for a wakeup if the worker stopped waiting
+	if(worker_sleeping.exchange(false)) { SDL_SemPost(worker_wakeup); }
+}
+
+/****** Wait until the render worker has drawn the queued scanline ******/
+void GPU::finish_scanline()
+{
+	for(u32 spins = 0; line_queued.load(std::memory_order_acquire); spins++)
+	{
+		//Let the worker run if it has to share a core
+		if(spins >= WORKER_SPIN_COUNT) { std::this_thread::yield(); }
+	}
+}
+
+/****** Render worker - Draws each queued scanline ******/
+void GPU::render_worker_loop()
+{
+	while(worker_running)
+	{
+		//Wait for a line - Spin briefly, then sleep until one is queued
+		u32 spins = 0;
+
+		while((!line_queued.load(std::memory_order_acquire)) && (worker_running))
+		{
+			if(++spins < WORKER_SPIN_COUNT) { continue; }
+
+			worker_sleeping = true;
+
+			//A line may have been queued before the worker said it was going to sleep
+			if((line_queued) || (!worker_running))
+			{
+				//If the CPU already cleared the flag, it also posted a wakeup that has to be consumed
+				if(!worker_sleeping.exchange(false)) { SDL_SemWait(worker_wakeup); }
+			}
+
+			else { SDL_SemWait(worker_wakeup); }
+
+			spins = 0;
+		}
+
+		if(!worker_running) { break; }
+
+		render_scanline();
+		line_queued.store(false, std::memory_order_release);
+	}
+}
@@ -0,0 +1,191 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : rewind.cpp
+// Date : October 17, 2026
+// Description : Rewind buffer
+//
+// Keeps a ring of in-memory save states, taken every few frames
+// Only 4KB pages that changed since the previous snapshot are stored
+
+#include <algorithm>
+#include <deque>
+
+#include "rewind.h"
+#include "savestate.h"
+#include "config.h"
+
+namespace rewind_buffer
+{
+	bool active = false;
+
+	//Newest snapshot, stored in full
+	std::vector<u8> latest;
+
+	//Older snapshots, oldest first - Each one turns the snapshot after it back into itself
+	std::deque< std::vector<u8> > deltas;
+
+	//Scratch buffers, kept around so taking a snapshot doesn't allocate
+	std::vector<u8> current;
+	std::vector<u8> delta;
+
+	u32 deltas_size = 0;
+	u32 frames = 0;
+}
+
+/****** Store the pages of an older snapshot that differ from a newer one - XOR'd, then run-length encoded ******/
+static void encode_delta(const std::vector<u8> &older, const std::vector<u8> &newer, std::vector<u8> &delta)
+{
+	u8 xor_page[rewind_buffer::PAGE_SIZE];
+
+	delta.clear();
+	savestate::write(delta, (u32)older.size());
+
+	for(u32 page_start = 0; page_start < older.size(); page_start += rewind_buffer::PAGE_SIZE)
+	{
+		u32 page_size = std::min(rewind_buffer::PAGE_SIZE, (u32)older.size() - page_start);
+
+		//Skip unchanged pages
+		if(((page_start + page_size) <= newer.size()) && (memcmp(&older[page_start], &newer[page_start], page_size) == 0)) { continue; }
+
+		for(u32 x = 0; x < page_size; x++)
+		{
+			u8 newer_byte = ((page_start + x) < newer.size()) ? newer[page_start + x] : 0;
+			xor_page[x] = older[page_start + x] ^ newer_byte;
+		}
+
+		savestate::write(delta, page_start);
+		u32 size_offset = delta.size();
+		savestate::write(delta, (u16)0);
+
+		//Runs of unchanged bytes, each followed by a run of changed bytes
+		u32 x = 0;
+
+		while(x < page_size)
+		{
+			u16 zeros = 0;
+			while((x < page_size) && (xor_page[x] == 0)) { zeros++; x++; }
+
+			//Changed bytes continue until 4 unchanged bytes in a row
+			u32 literal_start = x;
+			u32 literal_end = x;
+
+			while(literal_end < page_size)
+			{
+				u32 run = 0;
+				while(((literal_end + run) < page_size) && (run < 4) && (xor_page[literal_end + run] == 0)) { run++; }
+				if((run == 4) || ((literal_end + run) == page_size)) { break; }
+				literal_end += run + 1;
+			}
+
+			u16 literals = literal_end - literal_start;
+			savestate::write(delta, zeros);
+			savestate::write(delta, literals);
+			savestate::write(delta, &xor_page[literal_start], literals);
+			x = literal_end;
+		}
+
+		u16 encoded_size = delta.size() - (size_offset + 2);
+		memcpy(&delta[size_offset], &encoded_size, 2);
+	}
+}
+
+/****** Turn a snapshot back into the older one a delta was made from ******/
+static bool apply_delta(std::vector<u8> &state, const std::vector<u8> &delta)
+{
+	u32 offset = 0;
+	u32 older_size = 0;
+
+	if(!savestate::read(delta, offset, older_size)) { return false; }
+	state.resize(older_size, 0);
+
+	while(offset < delta.size())
+	{
+		u32 page_start = 0;
+		u16 encoded_size = 0;
+
+		if(!savestate::read(delta, offset, page_start) || !savestate::read(delta, offset, encoded_size)) { return false; }
+
+		u32 encoded_end = offset + encoded_size;
+		u32 x = page_start;
+
+		while(offset < encoded_end)
+		{
+			u16 zeros = 0;
+			u16 literals = 0;
+
+			if(!savestate::read(delta, offset, zeros) || !savestate::read(delta, offset, literals)) { return false; }
+			x += zeros;
+
+			if(((offset + literals) > delta.size()) || ((x + literals) > state.size())) { return false; }
+			for(u32 y = 0; y < literals; y++) { state[x++] ^= delta[offset++]; }
+		}
+	}
+
+	return true;
+}
+
+/****** Take a snapshot every few frames - Called once per frame ******/
+void rewind_buffer::capture(CPU& z80, GPU& gb_gpu, APU& gb_apu)
+{
+	if((config::rewind_budget == 0) || (++frames < config::rewind_interval)) { return; }
+	frames = 0;
+
+	save_state(z80, gb_gpu, gb_apu, current);
+
+	//Keep only what it takes to get from the new snapshot back to the previous one
+	if(!latest.empty())
+	{
+		encode_delta(latest, current, delta);
+		deltas.push_back(std::vector<u8>());
+		deltas.back().swap(delta);
+		deltas_size += deltas.back().size();
+	}
+
+	latest.swap(current);
+
+	//Drop the oldest snapshots once over budget
+	while((!deltas.empty()) && (memory_used() > ((u64)config::rewind_budget * 0x100000)))
+	{
+		deltas_size -= deltas.front().size();
+		deltas.pop_front();
+	}
+}
+
+/****** Go back one snapshot - Stays on the oldest snapshot once the buffer runs out ******/
+bool rewind_buffer::step_back(CPU& z80, GPU& gb_gpu, APU& gb_apu)
+{
+	if(latest.empty()) { return false; }
+
+	if(!deltas.empty())
+	{
+		deltas_size -= deltas.back().size();
+
+		if(!apply_delta(latest, deltas.back()))
+		{
+			clear();
+			return false;
+		}
+
+		deltas.pop_back();
+	}
+
+	frames = 0;
+	return load_state(z80, gb_gpu, gb_apu, latest);
+}
+
+/****** Empty the rewind buffer ******/
+void rewind_buffer::clear()
+{
+	latest.clear();
+	deltas.clear();
+	deltas_size = 0;
+	frames = 0;
+}
+
+/****** Number of snapshots held ******/
+u32 rewind_buffer::snapshot_count() { return (latest.empty()) ? 0 : (deltas.size() + 1); }
+
+/****** Memory held by snapshots, in bytes ******/
+u32 rewind_buffer::memory_used() { return latest.size() + deltas_size + (deltas.size() * sizeof(std::vector<u8>)); }
@@ -0,0 +1,37 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : rewind.h
+// Date : October 17, 2026
+// Description : Rewind buffer
+//
+// Keeps a ring of in-memory save states, taken every few frames
+// Only 4KB pages that changed since the previous snapshot are stored
+
+#ifndef GB_REWIND
+#define GB_REWIND
+
+#include "common.h"
+
+class CPU;
+class GPU;
+class APU;
+
+namespace rewind_buffer
+{
+	//Snapshots are compared and stored in pages of this size
+	const u32 PAGE_SIZE = 0x1000;
+
+	//Held while the rewind hotkey is down
+	extern bool active;
+
+	void capture(CPU& z80, GPU& gb_gpu, APU& gb_apu);
+	bool step_back(CPU& z80, GPU& gb_gpu, APU& gb_apu);
+	void clear();
+
+	u32 snapshot_count();
+	u32 memory_used();
+}
+
+#endif // GB_REWIND
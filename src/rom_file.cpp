@@ -0,0 +1,324 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : rom_file.cpp
+// Date : October 17, 2026
+// Description : Cartridge ROM storage
+//
+// Maps ROM files read-only into memory, so ROM banks are just pointers into the file
+// Gzip and zip archives are decompressed into a buffer, as are files that can't be mapped
+
+#include <iostream>
+#include <cctype>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "rom_file.h"
+#include "inflate.h"
+
+/****** Little-endian values inside archive headers ******/
+static u16 read_u16(const u8* data) { return data[0] | (data[1] << 8); }
+static u32 read_u32(const u8* data) { return data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24); }
+
+/****** ROMFile Constructor ******/
+ROMFile::ROMFile()
+{
+	data = NULL;
+	size = 0;
+	bank_count = 0;
+	mapped = false;
+	mapped_size = 0;
+}
+
+/****** ROMFile Destructor ******/
+ROMFile::~ROMFile() { unload(); }
+
+/****** Load a plain ROM, gzip, or zip file ******/
+bool ROMFile::load(std::string filename)
+{
+	unload();
+
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if(!file.is_open())
+	{
+		std::cout<<"MMU : " << filename << " could not be opened. Check file path or permissions. \n";
+		return false;
+	}
+
+	//Get the file size and check what kind of file it is
+	file.seekg(0, file.end);
+	u32 file_size = file.tellg();
+	file.seekg(0, file.beg);
+
+	u8 magic[4] = { 0, 0, 0, 0 };
+	file.read(reinterpret_cast<char*> (magic), 4);
+	file.clear();
+	file.seekg(0, file.beg);
+
+	bool result = false;
+
+	//Gzip
+	if((magic[0] == 0x1F) && (magic[1] == 0x8B)) { result = read_gzip(file, file_size); }
+
+	//Zip - Starts with a local file header
+	else if(read_u32(magic) == 0x04034B50) { result = read_zip(file, file_size); }
+
+	//Plain ROM - Map it, or read it if that fails
+	else { result = (file_size != 0) && (map_file(filename, file_size) || read_raw(file, file_size)); }
+
+	file.close();
+
+	if(!result)
+	{
+		std::cout<<"MMU : " << filename << " could not be read. The file may be damaged or use unsupported compression. \n";
+		unload();
+		return false;
+	}
+
+	fit(size);
+	return true;
+}
+
+/****** Pad the ROM to a power of 2 that holds at least rom_size bytes, up to 8MB - Anything past the end of the file reads as 0 ******/
+void ROMFile::fit(u32 rom_size)
+{
+	u32 padded = 0x8000;
+	while((padded < rom_size) && (padded < MAX_ROM_SIZE)) { padded <<= 1; }
+	bank_count = padded / 0x4000;
+
+	if(size >= padded) { return; }
+
+	//Mappings can't grow, so copy short files into the buffer
+	if(mapped)
+	{
+		buffer.assign(data, data + size);
+		unmap_file();
+	}
+
+	buffer.resize(padded, 0);
+	data = &buffer[0];
+	size = padded;
+}
+
+/****** Release the mapping or buffer ******/
+void ROMFile::unload()
+{
+	unmap_file();
+	std::vector<u8>().swap(buffer);
+
+	data = NULL;
+	size = 0;
+	bank_count = 0;
+}
+
+/****** Map a whole file read-only - Every instance running the same game shares its pages ******/
+bool ROMFile::map_file(std::string filename, u32 file_size)
+{
+	#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) { return false; }
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if(mapping != NULL)
+	{
+		data = (u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, file_size);
+		CloseHandle(mapping);
+	}
+
+	CloseHandle(file);
+	#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if(file == -1) { return false; }
+
+	void* view = mmap(NULL, file_size, PROT_READ, MAP_SHARED, file, 0);
+	if(view != MAP_FAILED) { data = (u8*)view; }
+
+	close(file);
+	#endif
+
+	if(data == NULL) { return false; }
+
+	mapped = true;
+	mapped_size = size = file_size;
+	return true;
+}
+
+/****** Release a file mapping ******/
+void ROMFile::unmap_file()
+{
+	if(!mapped) { return; }
+
+	#ifdef _WIN32
+	UnmapViewOfFile(data);
+	#else
+	munmap(data, mapped_size);
+	#endif
+
+	data = NULL;
+	mapped = false;
+	mapped_size = 0;
+}
+
+/****** Read a plain ROM one bank at a time ******/
+bool ROMFile::read_raw(std::ifstream &file, u32 file_size)
+{
+	buffer.resize(file_size);
+
+	for(u32 x = 0; (x < file_size) && (file.good()); x += 0x4000)
+	{
+		u32 length = ((file_size - x) < 0x4000) ? (file_size - x) : 0x4000;
+		file.read(reinterpret_cast<char*> (&buffer[x]), length);
+	}
+
+	if(!file.good()) { return false; }
+
+	data = &buffer[0];
+	size = file_size;
+	return true;
+}
+
+/****** Read a gzip file ******/
+bool ROMFile::read_gzip(std::ifstream &file, u32 file_size)
+{
+	u8 header[10];
+	u8 trailer[8];
+
+	//Header and trailer alone take 18 bytes - Deflate is the only compression method gzip defines
+	if(file_size < 18) { return false; }
+	file.read(reinterpret_cast<char*> (header), 10);
+	if(header[2] != 8) { return false; }
+
+	//Skip the optional extra field, file name, comment, and header CRC
+	if(header[3] & 0x04)
+	{
+		u8 extra_size[2];
+		file.read(reinterpret_cast<char*> (extra_size), 2);
+		file.seekg(read_u16(extra_size), file.cur);
+	}
+
+	if(header[3] & 0x08) { while(file.get() > 0) { } }
+	if(header[3] & 0x10) { while(file.get() > 0) { } }
+	if(header[3] & 0x02) { file.seekg(2, file.cur); }
+
+	if(!file.good()) { return false; }
+
+	u32 data_start = file.tellg();
+	if((data_start + 8) > file_size) { return false; }
+
+	//The trailer holds the CRC and the uncompressed size
+	file.seekg(file_size - 8);
+	file.read(reinterpret_cast<char*> (trailer), 8);
+	file.seekg(data_start);
+
+	return read_member(file, 8, file_size - 8 - data_start, read_u32(trailer + 4), read_u32(trailer));
+}
+
+/****** Read the ROM from a zip file - The first .gb or .gbc file, otherwise the first file ******/
+bool ROMFile::read_zip(std::ifstream &file, u32 file_size)
+{
+	//The end of central directory record is at the end of the file, followed only by a comment of up to 64KB
+	u32 tail_size = (file_size < 0x10016) ? file_size : 0x10016;
+	if(tail_size < 22) { return false; }
+
+	std::vector<u8> tail(tail_size);
+	file.seekg(file_size - tail_size);
+	file.read(reinterpret_cast<char*> (&tail[0]), tail_size);
+
+	s32 end_record = -1;
+	for(s32 x = tail_size - 22; x >= 0; x--) { if(read_u32(&tail[x]) == 0x06054B50) { end_record = x; break; } }
+	if(end_record == -1) { return false; }
+
+	u16 entries = read_u16(&tail[end_record + 10]);
+	u32 directory_size = read_u32(&tail[end_record + 12]);
+	u32 directory_offset = read_u32(&tail[end_record + 16]);
+
+	if((entries == 0) || (directory_size == 0) || ((directory_offset + directory_size) > file_size)) { return false; }
+
+	std::vector<u8> directory(directory_size);
+	file.seekg(directory_offset);
+	file.read(reinterpret_cast<char*> (&directory[0]), directory_size);
+	if(!file.good()) { return false; }
+
+	s32 first_file = -1;
+	s32 rom_file = -1;
+	u32 pos = 0;
+
+	for(u32 x = 0; (x < entries) && (rom_file == -1); x++)
+	{
+		if(((pos + 46) > directory_size) || (read_u32(&directory[pos]) != 0x02014B50)) { return false; }
+
+		u16 name_length = read_u16(&directory[pos + 28]);
+		if((pos + 46 + name_length) > directory_size) { return false; }
+
+		std::string name(reinterpret_cast<char*> (&directory[pos + 46]), name_length);
+		for(u32 y = 0; y < name.length(); y++) { name[y] = tolower(name[y]); }
+
+		bool folder = (name_length == 0) || (name[name_length - 1] == '/');
+		size_t dot = name.rfind('.');
+		std::string extension = (dot == std::string::npos) ? "" : name.substr(dot);
+
+		if((!folder) && (first_file == -1)) { first_file = pos; }
+		if((extension == ".gb") || (extension == ".gbc")) { rom_file = pos; }
+
+		pos += 46 + name_length + read_u16(&directory[pos + 30]) + read_u16(&directory[pos + 32]);
+	}
+
+	if(rom_file == -1) { rom_file = first_file; }
+	if(rom_file == -1) { return false; }
+
+	//Encrypted files can't be read
+	u8* entry = &directory[rom_file];
+	if(read_u16(entry + 8) & 0x1) { return false; }
+
+	//The local header's name and extra field can differ from the central directory's, so skip its own
+	u8 local[30];
+	u32 local_offset = read_u32(entry + 42);
+
+	file.seekg(local_offset);
+	file.read(reinterpret_cast<char*> (local), 30);
+	if((!file.good()) || (read_u32(local) != 0x04034B50)) { return false; }
+
+	file.seekg(local_offset + 30 + read_u16(local + 26) + read_u16(local + 28));
+	return read_member(file, read_u16(entry + 10), read_u32(entry + 20), read_u32(entry + 24), read_u32(entry + 16));
+}
+
+/****** Decompress an archived ROM straight into the buffer - Stored or deflated, checked against its CRC ******/
+bool ROMFile::read_member(std::ifstream &file, u16 method, u32 packed_size, u32 unpacked_size, u32 crc)
+{
+	if((unpacked_size == 0) || (unpacked_size > MAX_ROM_SIZE)) { return false; }
+
+	buffer.resize(unpacked_size);
+	u32 length = 0;
+
+	//Stored
+	if(method == 0)
+	{
+		if(packed_size != unpacked_size) { return false; }
+		file.read(reinterpret_cast<char*> (&buffer[0]), unpacked_size);
+		length = file.gcount();
+	}
+
+	//Deflate
+	else if(method == 8)
+	{
+		if(!inflate::decompress(file, packed_size, &buffer[0], unpacked_size, length)) { return false; }
+	}
+
+	else { return false; }
+
+	if((length != unpacked_size) || (inflate::crc32(&buffer[0], length) != crc)) { return false; }
+
+	data = &buffer[0];
+	size = unpacked_size;
+	return true;
+}
@@ -0,0 +1,58 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : rom_file.h
+// Date : October 17, 2026
+// Description : Cartridge ROM storage
+//
+// Maps ROM files read-only into memory, so ROM banks are just pointers into the file
+// Gzip and zip archives are decompressed into a buffer, as are files that can't be mapped
+
+#ifndef GB_ROM_FILE
+#define GB_ROM_FILE
+
+#include <string>
+#include <fstream>
+#include <vector>
+
+#include "common.h"
+
+//Largest ROM any MBC can address - 8MB
+const u32 MAX_ROM_SIZE = 0x800000;
+
+class ROMFile
+{
+	public:
+
+	//Whole ROM - Padded to a power of 2, at least as large as the size given by the cartridge header
+	u8* data;
+	u32 size;
+	u32 bank_count;
+
+	//True if data points into a file mapping, false if it points into buffer
+	bool mapped;
+	u32 mapped_size;
+	std::vector<u8> buffer;
+
+	ROMFile();
+	~ROMFile();
+
+	bool load(std::string filename);
+	void fit(u32 rom_size);
+	void unload();
+
+	/****** Pointer to a 16KB ROM bank - Bank numbers wrap around the ROM size like on hardware ******/
+	inline u8* bank(u16 number) { return data + ((number & (bank_count - 1)) * 0x4000); }
+
+	private:
+
+	bool map_file(std::string filename, u32 file_size);
+	void unmap_file();
+	bool read_raw(std::ifstream &file, u32 file_size);
+	bool read_gzip(std::ifstream &file, u32 file_size);
+	bool read_zip(std::ifstream &file, u32 file_size);
+	bool read_member(std::ifstream &file, u16 method, u32 packed_size, u32 unpacked_size, u32 crc);
+};
+
+#endif // GB_ROM_FILE
@@ -0,0 +1,186 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : savestate.cpp
+// Date : October 17, 2026
+// Description : Save states
+//
+// Serializes the CPU, MMU, GPU and APU into a compact, versioned binary format
+// States can be kept in memory or written to and read from files
+
+#include <iostream>
+#include <fstream>
+
+#include "savestate.h"
+#include "config.h"
+#include "z80.h"
+#include "gpu.h"
+#include "apu.h"
+#include "scheduler.h"
+
+/****** Start a new section - Returns the position of its size field ******/
+u32 savestate::begin_section(std::vector<u8> &state, u32 id)
+{
+	write(state, id);
+	u32 size_offset = state.size();
+	write(state, (u32)0);
+	return size_offset;
+}
+
+/****** Finish a section - Fills in its size ******/
+void savestate::end_section(std::vector<u8> &state, u32 size_offset)
+{
+	u32 size = state.size() - (size_offset + 4);
+	memcpy(&state[size_offset], &size, 4);
+}
+
+/****** Start reading a section - Checks its ID and that all of its data is present ******/
+bool savestate::enter_section(const std::vector<u8> &state, u32 &offset, u32 id, u32 &section_end)
+{
+	u32 section_id = 0;
+	u32 size = 0;
+
+	if(!read(state, offset, section_id) || !read(state, offset, size)) { return false; }
+	if((section_id != id) || ((offset + size) > state.size())) { return false; }
+
+	section_end = offset + size;
+	return true;
+}
+
+/****** Serialize the whole emulated system ******/
+bool save_state(CPU& z80, GPU& gb_gpu, APU& gb_apu, std::vector<u8> &state)
+{
+	state.clear();
+
+	//Header - Identifies the format and the game the state belongs to
+	savestate::write(state, savestate::MAGIC);
+	savestate::write(state, savestate::VERSION);
+	savestate::write(state, config::gb_type);
+	savestate::write(state, &z80.mem.memory_map[0x14D], 3);
+
+	u32 size_offset = savestate::begin_section(state, savestate::SECTION_CPU);
+	z80.save_state(state);
+	savestate::end_section(state, size_offset);
+
+	size_offset = savestate::begin_section(state, savestate::SECTION_MMU);
+	z80.mem.save_state(state);
+	savestate::end_section(state, size_offset);
+
+	size_offset = savestate::begin_section(state, savestate::SECTION_GPU);
+	gb_gpu.save_state(state);
+	savestate::end_section(state, size_offset);
+
+	size_offset = savestate::begin_section(state, savestate::SECTION_APU);
+	gb_apu.save_state(state);
+	savestate::end_section(state, size_offset);
+
+	return true;
+}
+
+/****** Restore each section of a save state, starting after the header ******/
+static bool load_sections(CPU& z80, GPU& gb_gpu, APU& gb_apu, const std::vector<u8> &state, u32 offset)
+{
+	u32 section_end = 0;
+
+	return savestate::enter_section(state, offset, savestate::SECTION_CPU, section_end)
+	&& z80.load_state(state, offset) && (offset == section_end)
+	&& savestate::enter_section(state, offset, savestate::SECTION_MMU, section_end)
+	&& z80.mem.load_state(state, offset) && (offset == section_end)
+	&& savestate::enter_section(state, offset, savestate::SECTION_GPU, section_end)
+	&& gb_gpu.load_state(state, offset) && (offset == section_end)
+	&& savestate::enter_section(state, offset, savestate::SECTION_APU, section_end)
+	&& gb_apu.load_state(state, offset) && (offset == section_end);
+}
+
+/****** Restore the whole emulated system - Leaves the system untouched on failure ******/
+bool load_state(CPU& z80, GPU& gb_gpu, APU& gb_apu, const std::vector<u8> &state)
+{
+	u32 offset = 0;
+	u32 magic = 0;
+	u16 version = 0;
+	u8 gb_type = 0;
+	u8 checksums[3];
+
+	if(!savestate::read(state, offset, magic) || (magic != savestate::MAGIC))
+	{
+		std::cout<<"GBE : Not a save state\n";
+		return false;
+	}
+
+	if(!savestate::read(state, offset, version) || (version != savestate::VERSION))
+	{
+		std::cout<<"GBE : Unsupported save state version - " << version << "\n";
+		return false;
+	}
+
+	if(!savestate::read(state, offset, gb_type) || !savestate::read(state, offset, checksums, 3)
+	|| (gb_type != config::gb_type) || (memcmp(checksums, &z80.mem.memory_map[0x14D], 3) != 0))
+	{
+		std::cout<<"GBE : Save state belongs to a different game or system\n";
+		return false;
+	}
+
+	//Keep the current state in case the new one turns out to be damaged
+	std::vector<u8> backup;
+	save_state(z80, gb_gpu, gb_apu, backup);
+
+	bool loaded = load_sections(z80, gb_gpu, gb_apu, state, offset);
+
+	if(!loaded)
+	{
+		std::cout<<"GBE : Save state is damaged\n";
+		load_sections(z80, gb_gpu, gb_apu, backup, offset);
+	}
+
+	//Every component's deadline has to be worked out again from the restored state
+	scheduler::resync();
+	return loaded;
+}
+
+/****** Save the emulated system to a file ******/
+bool save_state_file(CPU& z80, GPU& gb_gpu, APU& gb_apu, std::string filename)
+{
+	std::vector<u8> state;
+	save_state(z80, gb_gpu, gb_apu, state);
+
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open())
+	{
+		std::cout<<"GBE : Could not save state - " << filename << "\n";
+		return false;
+	}
+
+	file.write(reinterpret_cast<char*> (&state[0]), state.size());
+	file.close();
+
+	std::cout<<"GBE : Saved state - " << filename << "\n";
+	return true;
+}
+
+/****** Load the emulated system from a file ******/
+bool load_state_file(CPU& z80, GPU& gb_gpu, APU& gb_apu, std::string filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if(!file.is_open())
+	{
+		std::cout<<"GBE : Could not open save state - " << filename << "\n";
+		return false;
+	}
+
+	//Get the file size and read the whole state
+	file.seekg(0, file.end);
+	u32 file_size = file.tellg();
+	file.seekg(0, file.beg);
+
+	std::vector<u8> state(file_size);
+	if(file_size != 0) { file.read(reinterpret_cast<char*> (&state[0]), file_size); }
+	file.close();
+
+	if(!load_state(z80, gb_gpu, gb_apu, state)) { return false; }
+
+	std::cout<<"GBE : Loaded state - " << filename << "\n";
+	return true;
+}
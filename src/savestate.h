@@ -0,0 +1,67 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : savestate.h
+// Date : October 17, 2026
+// Description : Save states
+//
+// Serializes the CPU, MMU, GPU and APU into a compact, versioned binary format
+// States can be kept in memory or written to and read from files
+
+#ifndef GB_SAVESTATE
+#define GB_SAVESTATE
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include "common.h"
+
+class CPU;
+class GPU;
+class APU;
+
+namespace savestate
+{
+	//File identifier ("GBES") and format version - Bump VERSION whenever the layout of any section changes
+	const u32 MAGIC = 0x53454247;
+	const u16 VERSION = 5;
+
+	//Section identifiers - Each section is stored as ID, size, then data
+	enum section_id { SECTION_CPU = 1, SECTION_MMU, SECTION_GPU, SECTION_APU };
+
+	/****** Append raw data to a save state ******/
+	inline void write(std::vector<u8> &state, const void* data, u32 size)
+	{
+		const u8* bytes = reinterpret_cast<const u8*>(data);
+		state.insert(state.end(), bytes, bytes + size);
+	}
+
+	/****** Append a single value to a save state ******/
+	template <typename T> inline void write(std::vector<u8> &state, const T &value) { write(state, &value, sizeof(T)); }
+
+	/****** Read raw data from a save state - Fails if the state is too short ******/
+	inline bool read(const std::vector<u8> &state, u32 &offset, void* data, u32 size)
+	{
+		if((offset + size) > state.size()) { return false; }
+		memcpy(data, &state[offset], size);
+		offset += size;
+		return true;
+	}
+
+	/****** Read a single value from a save state ******/
+	template <typename T> inline bool read(const std::vector<u8> &state, u32 &offset, T &value) { return read(state, offset, &value, sizeof(T)); }
+
+	u32 begin_section(std::vector<u8> &state, u32 id);
+	void end_section(std::vector<u8> &state, u32 size_offset);
+	bool enter_section(const std::vector<u8> &state, u32 &offset, u32 id, u32 &section_end);
+}
+
+bool save_state(CPU& z80, GPU& gb_gpu, APU& gb_apu, std::vector<u8> &state);
+bool load_state(CPU& z80, GPU& gb_gpu, APU& gb_apu, const std::vector<u8> &state);
+
+bool save_state_file(CPU& z80, GPU& gb_gpu, APU& gb_apu, std::string filename);
+bool load_state_file(CPU& z80, GPU& gb_gpu, APU& gb_apu, std::string filename);
+
+#endif // GB_SAVESTATE
@@ -0,0 +1,64 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : scheduler.cpp
+// Date : October 17, 2026
+// Description : Event scheduler
+//
+// The CPU runs uninterrupted until the earliest deadline of the GPU, timers, or run limit
+// Then every component catches up in one step and registers its next deadline
+
+#include "scheduler.h"
+#include "z80.h"
+#include "gpu.h"
+#include "apu.h"
+
+namespace scheduler
+{
+	u64 cycle_count = 0;
+	u64 next_event = 0;
+	u64 deadline[EVENT_COUNT] = { NO_EVENT, NO_EVENT, NO_EVENT };
+	u64 last_event = 0;
+
+	//CPU speed the last step was taken with
+	u8 last_double_div = 1;
+}
+
+/****** Step the GPU, APU and timers up to the current cycle, then find the earliest deadline ******/
+void scheduler::run_events(CPU& z80, GPU& gb_gpu, APU& gb_apu)
+{
+	//Writes to LCDC and speed switches always ask for a step, so they can only come from the last instruction
+	//Cycles before it still run with the old settings
+	u32 earlier = (cycle_count - last_event) - z80.cycles;
+	last_event = cycle_count;
+
+	//Divide clock cycles to emulate double speed mode
+	u8 double_div = (z80.double_speed) ? 2 : 1;
+
+	//Update GPU - While the LCD is off, only the instruction that turns it back on counts towards the first line
+	if(deadline[EVENT_GPU] == NO_EVENT) { gb_gpu.step(z80.cycles / double_div); }
+	else { gb_gpu.step((earlier / last_double_div) + (z80.cycles / double_div)); }
+
+	int gpu_cycles = gb_gpu.event_cycles();
+	deadline[EVENT_GPU] = (gpu_cycles < 0) ? NO_EVENT : cycle_count + (gpu_cycles * double_div);
+
+	//Update APU
+	gb_apu.step();
+
+	//Update timers - DIV and TIMA are worked out when read, only a TIMA overflow needs stepping
+	z80.mem.timers.update();
+	deadline[EVENT_TIMA] = z80.mem.timers.next_event();
+
+	last_double_div = double_div;
+
+	next_event = NO_EVENT;
+	for(int x = 0; x < EVENT_COUNT; x++) { next_event = (deadline[x] < next_event) ? deadline[x] : next_event; }
+}
+
+/****** Start counting from the current cycle - After loading a state, nothing before it applies anymore ******/
+void scheduler::resync()
+{
+	last_event = cycle_count;
+	request_event();
+}
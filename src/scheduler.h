@@ -0,0 +1,55 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : scheduler.h
+// Date : October 17, 2026
+// Description : Event scheduler
+//
+// The CPU runs uninterrupted until the earliest deadline of the GPU, timers, or run limit
+// Then every component catches up in one step and registers its next deadline
+
+#ifndef GB_SCHEDULER
+#define GB_SCHEDULER
+
+#include "common.h"
+
+class CPU;
+class GPU;
+class APU;
+
+namespace scheduler
+{
+	//Components with deadlines
+	enum event_id { EVENT_GPU, EVENT_TIMA, EVENT_LIMIT, EVENT_COUNT };
+
+	//Deadline of a component with nothing to do
+	const u64 NO_EVENT = 0xFFFFFFFFFFFFFFFFULL;
+
+	//Longest skip for a halted CPU or idle loop - One frame, for when nothing is scheduled at all
+	const u32 MAX_SKIP_CYCLES = 70224;
+
+	//CPU cycles since startup, the cycle each component and the earliest one needs stepping on, and the cycle of the last step
+	extern u64 cycle_count;
+	extern u64 next_event;
+	extern u64 deadline[EVENT_COUNT];
+	extern u64 last_event;
+
+	/****** Step the components after the current instruction - For register writes they have to react to right away ******/
+	inline void request_event() { next_event = 0; }
+
+	/****** Cycles a halted CPU can skip - Only events can raise interrupts, and HALT waits in steps of 4 cycles ******/
+	inline u32 halt_cycles()
+	{
+		if(next_event <= cycle_count) { return 4; }
+
+		u64 wait = next_event - cycle_count;
+		if(wait > MAX_SKIP_CYCLES) { wait = MAX_SKIP_CYCLES; }
+		return (wait + 3) & ~3;
+	}
+
+	void run_events(CPU& z80, GPU& gb_gpu, APU& gb_apu);
+	void resync();
+}
+
+#endif // GB_SCHEDULER
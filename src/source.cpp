@@ -19,6 +19,10 @@
 #include "gpu.h"
 #include "apu.h"
 #include "hotkeys.h"
+#include "bench.h"
+#include "savestate.h"
+#include "rewind.h"
+#include "scheduler.h"
 
 int main(int argc, char* args[]) 
 {
@@ -36,8 +40,10 @@ int main(int argc, char* args[])
 
 	if(!parse_cli_args()) { return 1; }
 
-	//Initialize SDL
-	if(SDL_Init(SDL_INIT_EVERYTHING) == -1) 
+	//Initialize SDL - Headless mode only needs the timer
+	u32 sdl_flags = (config::headless) ? SDL_INIT_TIMER : SDL_INIT_EVERYTHING;
+
+	if(SDL_Init(sdl_flags) == -1) 
 	{
 		std::cout<<"Error : Could not initialize SDL\n";
 		return 1;
@@ -45,6 +51,8 @@ int main(int argc, char* args[])
 
 	std::cout<<"Initializing Z80 CPU... \n";
 	CPU z80;
+
+	if(config::use_jit) { z80.jit_init(); }
 	
 	std::cout<<"Initializing GPU... \n";
 	GPU gb_gpu;
@@ -58,7 +66,9 @@ int main(int argc, char* args[])
 	//Link APU and MMU
 	gb_apu.mem_link = &z80.mem;
 
-    	SDL_PauseAudio(0);
+	if((config::use_render_worker) && (gb_gpu.start_render_worker())) { std::cout<<"Using render worker thread... \n"; }
+
+    	if(!config::headless) { SDL_PauseAudio(0); }
 
 	//Determine if BIOS are HLE'd or LLE'd - Reset CPU accordingly
 	z80.mem.in_bios = config::use_bios;
@@ -66,25 +76,18 @@ int main(int argc, char* args[])
 	if(z80.mem.in_bios) { z80.reset_bios(); }
 	else { z80.reset(); }
 
-	u8 op = 0;
-	u8 double_div = 1;
+	u64 audio_cycles = 0;
+	u32 rewind_frame = 0;
+	u8 audio_buffer[4096];
 
-	//Initialize the screen - account for scaling, fullscreen
-	if((!config::use_scaling) && (!config::use_opengl)) 
-	{ 
-		gb_gpu.gpu_screen = SDL_SetVideoMode(160, 144, 32, SDL_SWSURFACE | config::flags); 
-		std::cout<<"Using SDL renderer... \n"; 
-	}
-	
-	else if((config::use_scaling) && (!config::use_opengl)) 
-	{ 
-		gb_gpu.gpu_screen = SDL_SetVideoMode((160 * config::scaling_factor), (144 * config::scaling_factor), 32, SDL_SWSURFACE | config::flags); 
-		std::cout<<"Using SDL renderer... \n";
-	}
-	
-	else if(config::use_opengl) { gb_gpu.opengl_init(); std::cout<<"Using OpenGL renderer... \n"; } 
+	//Initialize the screen - account for scaling, fullscreen - Headless mode has no screen
+	//With the presenter thread, the screen is set up and drawn to on that thread
+	if(config::headless) { std::cout<<"Running headless... \n"; }
+	else if((config::use_presenter) && (gb_gpu.start_presenter())) { std::cout<<"Using presenter thread... \n"; }
+	else { gb_gpu.init_screen(); }
 
-	SDL_WM_SetCaption("GBE", NULL);
+	if((!config::headless) && (config::use_opengl)) { std::cout<<"Using OpenGL renderer... \n"; }
+	else if(!config::headless) { std::cout<<"Using SDL renderer... \n"; }
 
 	//Read BIOS
 	if((z80.mem.in_bios) && (!z80.mem.read_bios("bios.bin"))) { return 1; }
@@ -96,81 +99,91 @@ int main(int argc, char* args[])
 	//Alter register values to reflect DMG or GBC support
 	if(config::gb_type == 2) { z80.reg.a = 0x11; }
 
+	//Start from a save state if requested
+	if((config::load_state_file != "") && (!load_state_file(z80, gb_gpu, gb_apu, config::load_state_file))) { return 1; }
+
+	if(config::bench) { std::cout<<"Running benchmark... \n"; bench::start(); }
+
+	//Stop after the requested number of emulated cycles
+	if(config::max_cycles != 0) { scheduler::deadline[scheduler::EVENT_LIMIT] = config::max_cycles; }
+
 	//Main loop
 	while(z80.running)
 	{
-		//Handle SDL Events
-		if((z80.mem.memory_map[REG_LY] == 144) && SDL_PollEvent(&event))
-		{
-			//X out of a window
-			if(event.type == SDL_QUIT) { z80.running = false; SDL_Quit(); }
-	
-			//Handle hotkeys or Game Pad input
-			else { process_keys(z80, gb_gpu, event); }
-		}
-
 		z80.cycles = 0;
 
 		//Handle Interrupts
 		z80.handle_interrupts();
 	
-		//Halt CPU if necessary
-		if(z80.halt == true) { z80.cycles += 4; }
+		//Halt CPU if necessary - Nothing can wake it up before the next event, so skip straight to it
+		if(z80.halt == true) { z80.cycles += scheduler::halt_cycles(); }
 
 		else 
 		{
-			//Process Op Codes
-			op = z80.mem.read_byte(z80.reg.pc++);
-			z80.exec_op(op);
+			//Process Op Codes - Runs from the decoded block cache when possible
+			z80.exec_cached_op();
 		}
 
-		//Divide clock cycles to emulate double speed mode
-		if(z80.double_speed) { double_div = 2; }
-		else { double_div = 1; }
+		//Only step the GPU, APU and timers once one of them has something to do
+		scheduler::cycle_count += z80.cycles;
+		if(scheduler::cycle_count < scheduler::next_event) { continue; }
 
-		//Update GPU
-		gb_gpu.step(z80.cycles/double_div);
+		scheduler::run_events(z80, gb_gpu, gb_apu);
 
-		//Update APU
-		gb_apu.step();
+		//Handle SDL Events - The presenter thread pumps them when it's running, so only take them from the queue
+		while((z80.running) && (!config::headless) && (z80.mem.memory_map[REG_LY] == 144)
+		&& ((gb_gpu.presenter != NULL) ? (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_ALLEVENTS) > 0) : SDL_PollEvent(&event)))
+		{
+			//X out of a window
+			if(event.type == SDL_QUIT) { z80.running = false; gb_gpu.stop_presenter(); SDL_Quit(); }
+	
+			//Handle hotkeys or Game Pad input
+			else { process_keys(z80, gb_gpu, gb_apu, event); }
+		}
 
-		//Update DIV timer - Every 4 M clocks
-		z80.div_counter += z80.cycles;
-		
-		if(z80.div_counter >= 256) 
+		//Benchmark - No audio device, so generate audio at the rate SDL would ask for it
+		if((config::bench) && ((scheduler::cycle_count - audio_cycles) >= bench::AUDIO_CYCLES))
 		{
-			z80.div_counter -= 256;
-			z80.mem.memory_map[REG_DIV]++;
+			audio_cycles += bench::AUDIO_CYCLES;
+			audio_callback(&gb_apu, audio_buffer, sizeof(audio_buffer));
 		}
 
-		//Update TIMA timer
-		if(z80.mem.memory_map[REG_TAC] & 0x4) 
-		{	
-			z80.tima_counter += z80.cycles;
-
-			switch(z80.mem.memory_map[REG_TAC] & 0x3)
-			{
-				case 0x00: z80.tima_speed = 1024; break;
-				case 0x01: z80.tima_speed = 16; break;
-				case 0x02: z80.tima_speed = 64; break;
-				case 0x03: z80.tima_speed = 256; break;
-			}
-	
-			if(z80.tima_counter >= z80.tima_speed)
-			{
-				z80.mem.memory_map[REG_TIMA]++;
-				z80.tima_counter -= z80.tima_speed;
-
-				if(z80.mem.memory_map[REG_TIMA] == 0)
-				{
-					z80.mem.memory_map[REG_IF] |= 0x04;
-					z80.mem.memory_map[REG_TIMA] = z80.mem.memory_map[REG_TMA];
-				}	
-
-			}
+		//Rewind - Take snapshots as frames complete, or step back through them while rewinding
+		if((config::rewind_budget != 0) && (gb_gpu.frame_count != rewind_frame))
+		{
+			rewind_frame = gb_gpu.frame_count;
+
+			if(rewind_buffer::active) { rewind_buffer::step_back(z80, gb_gpu, gb_apu); }
+			else { rewind_buffer::capture(z80, gb_gpu, gb_apu); }
 		}
+
+		//Stop after the requested number of frames or emulated cycles
+		if((config::max_frames != 0) && (gb_gpu.frame_count >= config::max_frames)) { z80.running = false; }
+		if((config::max_cycles != 0) && (scheduler::cycle_count >= config::max_cycles)) { z80.running = false; }
 	}
 
+	//Report benchmark results
+	if(config::bench)
+	{
+		bench::stop();
+		bench::report(config::rom_file, gb_gpu.frame_count, scheduler::cycle_count, z80.idle_loops, z80.idle_cycles_skipped, config::bench_file);
+	}
+
+	//Report the final frame in headless mode
+	if(config::headless)
+	{
+		std::cout<<"GBE : Ran " << gb_gpu.frame_count << " frames, " << scheduler::cycle_count << " cycles\n";
+		std::cout<<"GBE : Skipped " << z80.idle_loops << " idle loops, " << z80.idle_cycles_skipped << " cycles\n";
+		std::cout<<"GBE : Frame hash - " << std::hex << std::setw(16) << std::setfill('0') << gb_gpu.frame_hash() << std::dec << "\n";
+		if(config::dump_frame_file != "") { gb_gpu.dump_frame(config::dump_frame_file); }
+	}
+
+	//Stop presenting before anything else is torn down
+	gb_gpu.stop_presenter();
+
+	//Save the final state if requested
+	if(config::save_state_file != "") { save_state_file(z80, gb_gpu, gb_apu, config::save_state_file); }
+
 	//Save battery-backed RAM 
 	z80.mem.save_sram();
 
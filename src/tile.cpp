@@ -0,0 +1,42 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : tile.cpp
+// Date : October 17, 2026
+// Description : Game Boy tile decoding
+//
+// Expands 2bpp tile data into one color index (0-3) per pixel
+// Shared by background, window and sprite rendering
+
+#include "tile.h"
+
+namespace tile
+{
+	u8 bit_spread[0x100][8];
+	u8 bit_spread_flipped[0x100][8];
+}
+
+/****** Build the bit spreading table ******/
+void tile::init()
+{
+	for(int x = 0; x < 0x100; x++)
+	{
+		for(int y = 0; y < 8; y++)
+		{
+			bit_spread[x][y] = (x >> (7 - y)) & 0x1;
+			bit_spread_flipped[x][y] = (x >> y) & 0x1;
+		}
+	}
+}
+
+/****** Decode rows of a tile - 2 bytes per row in VRAM, 8 pixels per row out, optionally flipped ******/
+void tile::decode(const u8* tile_data, u8 rows, u8 pixel_data[], bool h_flip, bool v_flip)
+{
+	for(int row = 0; row < rows; row++)
+	{
+		u8 out_row = (v_flip) ? (rows - 1 - row) : row;
+		decode_row(tile_data[0], tile_data[1], &pixel_data[out_row * 8], h_flip);
+		tile_data += 2;
+	}
+}
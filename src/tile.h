@@ -0,0 +1,43 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : tile.h
+// Date : October 17, 2026
+// Description : Game Boy tile decoding
+//
+// Expands 2bpp tile data into one color index (0-3) per pixel
+// Shared by background, window and sprite rendering
+
+#ifndef GB_TILE
+#define GB_TILE
+
+#include <cstring>
+
+#include "common.h"
+
+namespace tile
+{
+	//Each byte spread out to 8 bytes, one bit per byte, leftmost pixel first - Flipped table has the rightmost pixel first
+	extern u8 bit_spread[0x100][8];
+	extern u8 bit_spread_flipped[0x100][8];
+
+	void init();
+	void decode(const u8* tile_data, u8 rows, u8 pixel_data[], bool h_flip = false, bool v_flip = false);
+
+	/****** Decode one row of 8 pixels from its two bit planes ******/
+	inline void decode_row(u8 low_plane, u8 high_plane, u8 pixel_data[], bool h_flip = false)
+	{
+		u8 (*spread)[8] = (h_flip) ? bit_spread_flipped : bit_spread;
+
+		//Bits are spread into separate bytes, so all 8 pixels combine at once
+		u64 low_bits, high_bits;
+		memcpy(&low_bits, spread[low_plane], 8);
+		memcpy(&high_bits, spread[high_plane], 8);
+
+		low_bits |= (high_bits << 1);
+		memcpy(pixel_data, &low_bits, 8);
+	}
+}
+
+#endif // GB_TILE
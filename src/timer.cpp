@@ -0,0 +1,205 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : timer.cpp
+// Date : October 17, 2026
+// Description : DIV and TIMA timers
+//
+// Models the 16-bit internal divider as the cycle it last started counting from
+// DIV and TIMA are worked out from the cycle count when read, only TIMA overflows are scheduled
+
+#include "timer.h"
+#include "scheduler.h"
+#include "savestate.h"
+
+/****** Timer Constructor ******/
+Timer::Timer()
+{
+	interrupt_flag = NULL;
+	reset(0);
+}
+
+/****** Timer Destructor ******/
+Timer::~Timer() { }
+
+/****** Start the divider at the given value with TIMA stopped ******/
+void Timer::reset(u16 divider)
+{
+	divider_start = scheduler::cycle_count - divider;
+	tima_cycle = scheduler::cycle_count;
+	tima = 0;
+	tma = 0;
+	tac = 0xF8;
+	reload_pending = false;
+	reload_cycle = 0;
+}
+
+/****** Cycles between TIMA ticks for the current TAC ******/
+u32 Timer::tick_period()
+{
+	switch(tac & 0x3)
+	{
+		case 0x00: return 1024;
+		case 0x01: return 16;
+		case 0x02: return 64;
+		default: return 256;
+	}
+}
+
+/****** TIMA ticks when the divider bit selected by TAC falls - Returns the bit ANDed with the enable bit ******/
+bool Timer::tick_input()
+{
+	u64 divider = scheduler::cycle_count - divider_start;
+	return ((tac & 0x4) && (divider & (tick_period() >> 1)));
+}
+
+/****** Tick TIMA once at the current cycle ******/
+void Timer::tick()
+{
+	if(++tima == 0)
+	{
+		reload_pending = true;
+		reload_cycle = scheduler::cycle_count + 4;
+	}
+}
+
+/****** Bring TIMA up to the current cycle - Every falling edge of the selected divider bit since the last update is a tick ******/
+void Timer::update()
+{
+	u64 now = scheduler::cycle_count;
+
+	while(true)
+	{
+		//Finish an overflow
+		if(reload_pending)
+		{
+			if(reload_cycle > now) { break; }
+
+			tima = tma;
+			tima_cycle = reload_cycle;
+			reload_pending = false;
+			if(interrupt_flag != NULL) { *interrupt_flag |= 0x04; }
+		}
+
+		if((tac & 0x4) == 0) { break; }
+
+		//First tick after the last update
+		u32 period = tick_period();
+		u64 first_tick = tima_cycle + period - ((tima_cycle - divider_start) % period);
+		if(first_tick > now) { break; }
+
+		u64 ticks = ((now - first_tick) / period) + 1;
+		if(ticks < (u64)(0x100 - tima)) { tima += ticks; break; }
+
+		//Overflow - No ticks can land inside the 4 cycle reload delay, the shortest period is 16
+		tima_cycle = first_tick + ((0xFF - tima) * period);
+		tima = 0;
+		reload_pending = true;
+		reload_cycle = tima_cycle + 4;
+	}
+
+	tima_cycle = now;
+}
+
+/****** Cycle TIMA next raises an interrupt - NO_EVENT if it is stopped ******/
+u64 Timer::next_event()
+{
+	if(reload_pending) { return reload_cycle; }
+	if((tac & 0x4) == 0) { return scheduler::NO_EVENT; }
+
+	u32 period = tick_period();
+	u64 first_tick = tima_cycle + period - ((tima_cycle - divider_start) % period);
+	return first_tick + ((0xFF - tima) * period) + 4;
+}
+
+/****** First cycle after the given one where DIV reads differently ******/
+u64 Timer::next_div_change(u64 cycle)
+{
+	return cycle + 0x100 - ((cycle - divider_start) & 0xFF);
+}
+
+/****** Read DIV, TIMA, TMA, or TAC ******/
+u8 Timer::read(u16 address)
+{
+	switch(address)
+	{
+		case REG_DIV: return ((scheduler::cycle_count - divider_start) >> 8) & 0xFF;
+		case REG_TIMA: update(); return tima;
+		case REG_TMA: return tma;
+		default: return tac;
+	}
+}
+
+/****** Write DIV, TIMA, TMA, or TAC ******/
+void Timer::write(u16 address, u8 value)
+{
+	update();
+
+	switch(address)
+	{
+		//Any write resets the divider - If the selected bit was set, it falls and TIMA ticks
+		case REG_DIV:
+			if(tick_input()) { tick(); }
+			divider_start = scheduler::cycle_count;
+			break;
+
+		//Writing TIMA while an overflow waits for its reload cancels the reload and the interrupt
+		case REG_TIMA:
+			tima = value;
+			reload_pending = false;
+			break;
+
+		case REG_TMA:
+			tma = value;
+			break;
+
+		//Stopping TIMA or switching to a cleared bit looks like a falling edge as well
+		default:
+		{
+			bool old_input = tick_input();
+			tac = value | 0xF8;
+			if(old_input && !tick_input()) { tick(); }
+			break;
+		}
+	}
+
+	//The next overflow has moved
+	if(address != REG_TMA) { scheduler::request_event(); }
+}
+
+/****** Save timer state - Cycles are stored relative to the current one ******/
+void Timer::save_state(std::vector<u8> &state)
+{
+	update();
+
+	u16 divider = scheduler::cycle_count - divider_start;
+	u8 reload_delay = reload_pending ? (reload_cycle - scheduler::cycle_count) : 0;
+
+	savestate::write(state, divider);
+	savestate::write(state, tima);
+	savestate::write(state, tma);
+	savestate::write(state, tac);
+	savestate::write(state, reload_pending);
+	savestate::write(state, reload_delay);
+}
+
+/****** Load timer state ******/
+bool Timer::load_state(const std::vector<u8> &state, u32 &offset)
+{
+	u16 divider = 0;
+	u8 reload_delay = 0;
+
+	bool result = savestate::read(state, offset, divider)
+	&& savestate::read(state, offset, tima)
+	&& savestate::read(state, offset, tma)
+	&& savestate::read(state, offset, tac)
+	&& savestate::read(state, offset, reload_pending)
+	&& savestate::read(state, offset, reload_delay);
+
+	divider_start = scheduler::cycle_count - divider;
+	tima_cycle = scheduler::cycle_count;
+	reload_cycle = scheduler::cycle_count + reload_delay;
+
+	return result;
+}
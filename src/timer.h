@@ -0,0 +1,62 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : timer.h
+// Date : October 17, 2026
+// Description : DIV and TIMA timers
+//
+// Models the 16-bit internal divider as the cycle it last started counting from
+// DIV and TIMA are worked out from the cycle count when read, only TIMA overflows are scheduled
+
+#ifndef GB_TIMER
+#define GB_TIMER
+
+#include <vector>
+
+#include "common.h"
+
+class Timer
+{
+	public:
+
+	//Cycle the internal divider was last 0 - DIV is its upper 8 bits
+	u64 divider_start;
+
+	//TIMA and the cycle it was last brought up to date
+	u8 tima;
+	u64 tima_cycle;
+
+	u8 tma;
+	u8 tac;
+
+	//After overflowing, TIMA reads 0 for 4 cycles before TMA is reloaded and the interrupt is raised
+	bool reload_pending;
+	u64 reload_cycle;
+
+	//IF register the overflow interrupt is raised in
+	u8* interrupt_flag;
+
+	Timer();
+	~Timer();
+
+	void reset(u16 divider);
+
+	u8 read(u16 address);
+	void write(u16 address, u8 value);
+
+	void update();
+	u64 next_event();
+	u64 next_div_change(u64 cycle);
+
+	void save_state(std::vector<u8> &state);
+	bool load_state(const std::vector<u8> &state, u32 &offset);
+
+	private:
+
+	u32 tick_period();
+	bool tick_input();
+	void tick();
+};
+
+#endif // GB_TIMER
@@ -9,10 +9,20 @@
 // Emulates the GB CPU in software
 
 #include "z80.h"
+#include "savestate.h"
+#include "scheduler.h"
 
 /****** CPU Constructor ******/
 CPU::CPU() 
 {
+	jit_buffer = NULL;
+	jit_buffer_size = 0;
+	jit_buffer_pos = 0;
+	jit_enabled = false;
+	jit_flush = false;
+	idle_loops = 0;
+	idle_cycles_skipped = 0;
+
 	reset();
 }
 
@@ -37,15 +47,19 @@ void CPU::reset()
 	temp_word = 0;
 	cpu_clock_m = 0;
 	cpu_clock_t = 0;
-	div_counter = 0;
-	tima_counter = 0;
-	tima_speed = 0;
 	cycles = 0;
 	running = false;
 	halt = false;
 	pause = false;
 	interrupt = false;
 	double_speed = false;
+	use_operand = false;
+	operand = 0;
+	flag_op = LAZY_NONE;
+	flag_one = flag_two = 0;
+	flag_result = 0;
+	flag_carry = 0;
+	flush_blocks();
 }
 
 /****** CPU Reset - For BIOS ******/
@@ -65,15 +79,62 @@ void CPU::reset_bios()
 	temp_word = 0;
 	cpu_clock_m = 0;
 	cpu_clock_t = 0;
-	div_counter = 0;
-	tima_counter = 0;
-	tima_speed = 0;
 	cycles = 0;
 	running = false;
 	halt = false;
 	pause = false;
 	interrupt = false;
 	double_speed = false;
+	use_operand = false;
+	operand = 0;
+	flag_op = LAZY_NONE;
+	flag_one = flag_two = 0;
+	flag_result = 0;
+	flag_carry = 0;
+	flush_blocks();
+}
+
+/****** Save CPU state ******/
+void CPU::save_state(std::vector<u8> &state)
+{
+	//Materialize lazy flags so F is stored as-is
+	sync_flags();
+
+	savestate::write(state, reg.af);
+	savestate::write(state, reg.bc);
+	savestate::write(state, reg.de);
+	savestate::write(state, reg.hl);
+	savestate::write(state, reg.pc);
+	savestate::write(state, reg.sp);
+
+	savestate::write(state, interrupt);
+	savestate::write(state, halt);
+	savestate::write(state, pause);
+	savestate::write(state, double_speed);
+}
+
+/****** Load CPU state ******/
+bool CPU::load_state(const std::vector<u8> &state, u32 &offset)
+{
+	bool result = savestate::read(state, offset, reg.af)
+	&& savestate::read(state, offset, reg.bc)
+	&& savestate::read(state, offset, reg.de)
+	&& savestate::read(state, offset, reg.hl)
+	&& savestate::read(state, offset, reg.pc)
+	&& savestate::read(state, offset, reg.sp)
+	&& savestate::read(state, offset, interrupt)
+	&& savestate::read(state, offset, halt)
+	&& savestate::read(state, offset, pause)
+	&& savestate::read(state, offset, double_speed);
+
+	//F was saved fully evaluated
+	flag_op = LAZY_NONE;
+	use_operand = false;
+
+	//Code in memory may have changed completely, drop all decoded blocks
+	flush_blocks();
+
+	return result;
 }
 
 /****** Handle Interrupts to CPU ******/
@@ -130,6 +191,86 @@ bool CPU::handle_interrupts()
 	else { return false; }
 }	
 
+/****** Fetch immediate byte ******/
+u8 CPU::fetch_byte(u16 address)
+{
+	//Instructions from the block cache already have their immediate data decoded
+	if(use_operand) { return (operand & 0xFF); }
+	else { return mem.read_byte(address); }
+}
+
+/****** Fetch immediate word ******/
+u16 CPU::fetch_word(u16 address)
+{
+	if(use_operand) { return operand; }
+	else { return mem.read_word(address); }
+}
+
+/****** Calculate flags from the last lazy operation ******/
+void CPU::sync_flags()
+{
+	switch(flag_op)
+	{
+		case LAZY_NONE : return;
+
+		case LAZY_ADD :
+			reg.f = 0;
+			if(flag_result > 0xFF) { reg.f |= 0x10; }
+			if((flag_one & 0xF) + (flag_two & 0xF) > 0xF) { reg.f |= 0x20; }
+			break;
+
+		case LAZY_SUB :
+			reg.f = 0x40;
+			if(flag_one < flag_two) { reg.f |= 0x10; }
+			if((flag_one & 0xF) < (flag_two & 0xF)) { reg.f |= 0x20; }
+			break;
+
+		case LAZY_INC :
+			reg.f = (flag_carry << 4);
+			if((flag_result & 0xF) == 0) { reg.f |= 0x20; }
+			break;
+
+		case LAZY_DEC :
+			reg.f = 0x40 | (flag_carry << 4);
+			if((flag_result & 0xF) == 0xF) { reg.f |= 0x20; }
+			break;
+
+		case LAZY_AND :
+			reg.f = 0x20;
+			break;
+
+		case LAZY_LOGIC :
+			reg.f = 0;
+			break;
+	}
+
+	//Zero
+	if((flag_result & 0xFF) == 0) { reg.f |= 0x80; }
+
+	flag_op = LAZY_NONE;
+}
+
+/****** Read Zero flag without calculating the rest of F ******/
+u8 CPU::lazy_zero()
+{
+	if(flag_op == LAZY_NONE) { return (reg.f & 0x80) ? 1 : 0; }
+	else { return ((flag_result & 0xFF) == 0) ? 1 : 0; }
+}
+
+/****** Read Carry flag without calculating the rest of F ******/
+u8 CPU::lazy_carry()
+{
+	switch(flag_op)
+	{
+		case LAZY_NONE : return (reg.f & 0x10) ? 1 : 0;
+		case LAZY_ADD : return (flag_result > 0xFF) ? 1 : 0;
+		case LAZY_SUB : return (flag_one < flag_two) ? 1 : 0;
+		case LAZY_INC :
+		case LAZY_DEC : return flag_carry;
+		default : return 0;
+	}
+}
+
 /****** Relative jump by signed immediate ******/
 void CPU::jr(u8 reg_one)
 {
@@ -145,6 +286,7 @@ void CPU::jr(u8 reg_one)
 /****** Swaps nibbles ******/
 u8 CPU::swap(u8 reg_one)
 {
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 	u8 temp_one = (reg_one & 0xF) << 4;
 	u8 temp_two = (reg_one >> 4) & 0xF;
@@ -159,24 +301,20 @@ u8 CPU::swap(u8 reg_one)
 /****** 8-bit addition ******/
 u8 CPU::add_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
-
-	//Carry
-	if(reg_one + reg_two > 0xFF) { reg.f |= 0x10; }
-
-	//Half-Carry
-	if((reg_one & 0xF) + (reg_two & 0xF) > 0xF) { reg.f |= 0x20; }
+	//Flags are calculated later, only if something reads them
+	flag_op = LAZY_ADD;
+	flag_one = reg_one;
+	flag_two = reg_two;
+	flag_result = reg_one + reg_two;
 
-	//Zero
-	if(u8(reg_one + reg_two) == 0) { reg.f |= 0x80; }
-
-	return reg_one + reg_two;
+	return flag_result;
 }
 
 /****** 8-bit addition - Carry ******/
 u8 CPU::add_carry(u8 reg_one, u8 reg_two)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	u8 carry_flag = lazy_carry();
+	flag_op = LAZY_NONE;
 	u8 carry_set = 0;
 	u8 half_carry_set = 0;
 
@@ -209,7 +347,8 @@ u8 CPU::add_carry(u8 reg_one, u8 reg_two)
 /****** 16-bit addition ******/
 u16 CPU::add_word(u16 reg_one, u16 reg_two)
 {
-	u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
+	u8 zero_flag = lazy_zero();
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 
 	//Carry
@@ -230,6 +369,7 @@ u16 CPU::add_signed_byte(u16 reg_one, u8 reg_two)
 	s16 reg_two_bsx = (s16)((s8)reg_two);
 	u16 result = reg_one + reg_two_bsx;
 
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 
 	//Carry
@@ -244,27 +384,19 @@ u16 CPU::add_signed_byte(u16 reg_one, u8 reg_two)
 /****** 8-bit subtraction ******/
 u8 CPU::sub_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
-
-	//Carry
-	if(reg_one < reg_two) { reg.f |= 0x10; }
-
-	//Half Carry
-	if((reg_one & 0xF) < (reg_two & 0xF)) { reg.f |= 0x20; }
-
-	//Subtract
-	reg.f |= 0x40;
-
-	//Zero
-	if(u8(reg_one - reg_two) == 0) { reg.f |= 0x80; }
+	flag_op = LAZY_SUB;
+	flag_one = reg_one;
+	flag_two = reg_two;
+	flag_result = u8(reg_one - reg_two);
 
-	return reg_one - reg_two;
+	return flag_result;
 }
 
 /****** 8-bit subtraction - Carry ******/
 u8 CPU::sub_carry(u8 reg_one, u8 reg_two)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	u8 carry_flag = lazy_carry();
+	flag_op = LAZY_NONE;
 	u8 carry_set = 0;
 	u8 half_carry_set = 0;
 
@@ -300,55 +432,39 @@ u8 CPU::sub_carry(u8 reg_one, u8 reg_two)
 /****** 8-bit AND ******/
 u8 CPU::and_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
-
-	//Half Carry
-	reg.f |= 0x20;
-
-	//Zero
-	if((reg_one & reg_two) == 0) { reg.f |= 0x80; }
+	flag_op = LAZY_AND;
+	flag_result = reg_one & reg_two;
 
-	return reg_one & reg_two;
+	return flag_result;
 }
 
 /****** 8-bit OR ******/
 u8 CPU::or_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
-
-	//Zero
-	if((reg_one | reg_two) == 0) { reg.f |= 0x80; }
+	flag_op = LAZY_LOGIC;
+	flag_result = reg_one | reg_two;
 
-	return reg_one | reg_two;
+	return flag_result;
 }
 
 /****** 8-bit XOR ******/
 u8 CPU::xor_byte(u8 reg_one, u8 reg_two)
 {
-	reg.f = 0;
-	
-	//Zero
-	if((reg_one ^ reg_two) == 0) { reg.f |= 0x80; }
+	flag_op = LAZY_LOGIC;
+	flag_result = reg_one ^ reg_two;
 
-	return reg_one ^ reg_two;
+	return flag_result;
 }
 
 /****** 8-bit increment ******/
 u8 CPU::inc_byte(u8 reg_one)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	//Carry is unaffected, so keep the current one
+	flag_carry = lazy_carry();
 	reg_one++;
 
-	reg.f = 0;
-
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
-
-	//Half Carry
-	if((reg_one & 0xF) == 0) { reg.f |= 0x20; }
-
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
+	flag_op = LAZY_INC;
+	flag_result = reg_one;
 
 	return reg_one;
 }
@@ -356,22 +472,11 @@ u8 CPU::inc_byte(u8 reg_one)
 /****** 8-bit decrement ******/
 u8 CPU::dec_byte(u8 reg_one)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	flag_carry = lazy_carry();
 	reg_one--;
 
-	reg.f = 0;
-
-	//Subtract
-	reg.f |= 0x40;
-
-	//Carry
-	if(carry_flag == 1) { reg.f |= 0x10; }
-
-	//Half Carry
-	if((reg_one & 0xF) == 0xF) { reg.f |= 0x20; }
-
-	//Zero
-	if(reg_one == 0) { reg.f |= 0x80; }
+	flag_op = LAZY_DEC;
+	flag_result = reg_one;
 
 	return reg_one;
 }
@@ -379,7 +484,8 @@ u8 CPU::dec_byte(u8 reg_one)
 /****** Check bit ******/
 void CPU::bit(u8 reg_one, u8 check_bit)
 {
-	u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+	u8 carry_flag = lazy_carry();
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 
 	//Carry
@@ -409,7 +515,8 @@ u8 CPU::set(u8 reg_one, u8 set_bit)
 /****** Rotate byte left *****/
 u8 CPU::rotate_left(u8 reg_one)
 {
-	u8 old_carry = (reg.f & 0x10) ? 1 : 0;
+	u8 old_carry = lazy_carry();
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 	
 	u8 carry_flag = (reg_one & 0x80) >> 7;
@@ -427,6 +534,7 @@ u8 CPU::rotate_left(u8 reg_one)
 /****** Rotate byte left through carry *****/
 u8 CPU::rotate_left_carry(u8 reg_one)
 {
+	flag_op = LAZY_NONE;
 	reg.f = 0;	
 
 	u8 carry_flag = (reg_one & 0x80) >> 7;
@@ -444,7 +552,8 @@ u8 CPU::rotate_left_carry(u8 reg_one)
 /****** Rotate byte right  ******/
 u8 CPU::rotate_right(u8 reg_one)
 {
-	u8 old_carry = (reg.f & 0x10) ? 1 : 0;
+	u8 old_carry = lazy_carry();
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 
 	u8 carry_flag = (reg_one & 0x01);
@@ -462,6 +571,7 @@ u8 CPU::rotate_right(u8 reg_one)
 /****** Rotate byte right through carry ******/
 u8 CPU::rotate_right_carry(u8 reg_one)
 {
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 
 	//Store 1st bit in Carry Flag
@@ -480,6 +590,7 @@ u8 CPU::rotate_right_carry(u8 reg_one)
 /****** Shift byte left into carry - Preserve sign ******/
 u8 CPU::sla(u8 reg_one)
 {
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 	u8 carry_flag = (reg_one & 0x80) ? 1 : 0;
 	reg_one <<= 1;
@@ -496,6 +607,7 @@ u8 CPU::sla(u8 reg_one)
 /****** Shift byte right into carry - Preserve sign ******/
 u8 CPU::sra(u8 reg_one)
 {
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 	u8 carry_flag = (reg_one & 0x01) ? 1 : 0;
 	reg_one >>= 1;
@@ -513,6 +625,7 @@ u8 CPU::sra(u8 reg_one)
 /****** Shift byte right into carry ******/
 u8 CPU::srl(u8 reg_one)
 {
+	flag_op = LAZY_NONE;
 	reg.f = 0;
 	u8 carry_flag = (reg_one & 0x01) ? 1 : 0;
 	reg_one >>= 1;
@@ -530,7 +643,8 @@ u8 CPU::srl(u8 reg_one)
 u8 CPU::daa()
 {
 	u32 reg_one = reg.a;
-	
+	sync_flags();
+
 	//Add or subtract correction values based on Subtract Flag
 	if(!(reg.f & 0x40))
 	{
@@ -570,7 +684,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD BC, nn
 		case 0x01 :
-			reg.bc = mem.read_word(reg.pc);
+			reg.bc = fetch_word(reg.pc);
 			reg.pc += 2;
 			cycles += 12;
 			break;
@@ -601,7 +715,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD B, n
 		case 0x06 :
-			reg.b = mem.read_byte(reg.pc++);
+			reg.b = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
@@ -614,7 +728,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD nn, SP
 		case 0x08 :
-			mem.write_word(mem.read_word(reg.pc), reg.sp);
+			mem.write_word(fetch_word(reg.pc), reg.sp);
 			reg.pc += 2;
 			cycles += 20;
 			break;
@@ -651,7 +765,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD C, n
 		case 0x0E :
-			reg.c = mem.read_byte(reg.pc++);
+			reg.c = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
@@ -677,11 +791,14 @@ void CPU::exec_op(u8 opcode)
 				double_speed = false;
 				mem.memory_map[REG_KEY1] = 0;
 			}
+
+			//The GPU has to switch clock rates from here on
+			scheduler::request_event();
 			break;	
 
 		//LD DE, nn
 		case 0x11 :
-			reg.de = mem.read_word(reg.pc);
+			reg.de = fetch_word(reg.pc);
 			reg.pc += 2;
 			cycles += 12;
 			break;
@@ -712,7 +829,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD D, n
 		case 0x16 :
-			reg.d = mem.read_byte(reg.pc++);
+			reg.d = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
@@ -725,7 +842,7 @@ void CPU::exec_op(u8 opcode)
 
 		//JR, n
 		case 0x18 :
-			jr(mem.read_byte(reg.pc++));
+			jr(fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -761,7 +878,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD E, n
 		case 0x1E :
-			reg.e = mem.read_byte(reg.pc++);
+			reg.e = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
@@ -775,8 +892,8 @@ void CPU::exec_op(u8 opcode)
 		//JR NZ, n
 		case 0x20 :	
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
-				if(zero_flag == 0) { jr(mem.read_byte(reg.pc));}
+				u8 zero_flag = lazy_zero();
+				if(zero_flag == 0) { jr(fetch_byte(reg.pc));}
 				cycles += 8;
 				reg.pc++;
 			}
@@ -784,7 +901,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD HL, nn
 		case 0x21 :
-			reg.hl = mem.read_word(reg.pc);
+			reg.hl = fetch_word(reg.pc);
 			reg.pc+=2;
 			cycles += 12;
 			break;
@@ -816,7 +933,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD H, n
 		case 0x26 : 
-			reg.h = mem.read_byte(reg.pc++);
+			reg.h = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
@@ -829,8 +946,8 @@ void CPU::exec_op(u8 opcode)
 		//JR Z, n
 		case 0x28 :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
-				if(zero_flag == 1) { jr(mem.read_byte(reg.pc));}
+				u8 zero_flag = lazy_zero();
+				if(zero_flag == 1) { jr(fetch_byte(reg.pc));}
 				cycles += 8;
 				reg.pc++;
 			}
@@ -869,12 +986,13 @@ void CPU::exec_op(u8 opcode)
 
 		//LD L, n
 		case 0x2E :
-			reg.l = mem.read_byte(reg.pc++);
+			reg.l = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
 		//CPL
 		case 0x2F :
+			sync_flags();
 			reg.a = ~reg.a;
 			reg.f |= 0x60;
 			cycles += 4;
@@ -883,8 +1001,8 @@ void CPU::exec_op(u8 opcode)
 		//JR NC, n
 		case 0x30 :	
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-				if(carry_flag == 0) { jr(mem.read_byte(reg.pc));}
+				u8 carry_flag = lazy_carry();
+				if(carry_flag == 0) { jr(fetch_byte(reg.pc));}
 				cycles += 8;
 				reg.pc++;
 			}
@@ -892,7 +1010,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD SP, nn
 		case 0x31 : 
-			reg.sp = mem.read_word(reg.pc);
+			reg.sp = fetch_word(reg.pc);
 			reg.pc += 2;
 			cycles += 12;
 			break;
@@ -927,14 +1045,15 @@ void CPU::exec_op(u8 opcode)
 
 		//LD HL, n
 		case 0x36 :
-			mem.write_byte(reg.hl, mem.read_byte(reg.pc++));
+			mem.write_byte(reg.hl, fetch_byte(reg.pc++));
 			cycles += 12;
 			break;
 
 		//SCF
 		case 0x37 :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
+				u8 zero_flag = lazy_zero();
+				flag_op = LAZY_NONE;
 				reg.f = 0;
 				if(zero_flag == 1) { reg.f |= 0x80; }
 				reg.f |= 0x10;
@@ -945,8 +1064,8 @@ void CPU::exec_op(u8 opcode)
 		//JR C, n
 		case 0x38 :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-				if(carry_flag == 1) { jr(mem.read_byte(reg.pc));}
+				u8 carry_flag = lazy_carry();
+				if(carry_flag == 1) { jr(fetch_byte(reg.pc));}
 				cycles += 8;
 				reg.pc++;
 			}
@@ -985,15 +1104,16 @@ void CPU::exec_op(u8 opcode)
 
 		//LD A, n
 		case 0x3E :
-			reg.a = mem.read_byte(reg.pc++);
+			reg.a = fetch_byte(reg.pc++);
 			cycles += 8;
 			break;
 
 		//CCF
 		case 0x3F :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+				u8 zero_flag = lazy_zero();
+				u8 carry_flag = lazy_carry();
+				flag_op = LAZY_NONE;
 				reg.f = 0;
 
 				if(zero_flag == 1) { reg.f |= 0x80; }
@@ -1776,7 +1896,7 @@ void CPU::exec_op(u8 opcode)
 		//RET NZ
 		case 0xC0 :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
+				u8 zero_flag = lazy_zero();
 				if(zero_flag == 0) { reg.pc = mem.read_word(reg.sp); reg.sp += 2; }
 				cycles += 8;
 			}
@@ -1792,8 +1912,8 @@ void CPU::exec_op(u8 opcode)
 		//JP NZ nn
 		case 0xC2 :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
-				if(zero_flag == 0) { reg.pc = mem.read_word(reg.pc); }
+				u8 zero_flag = lazy_zero();
+				if(zero_flag == 0) { reg.pc = fetch_word(reg.pc); }
 				else { reg.pc += 2; }
 				cycles += 12; 
 			}
@@ -1801,20 +1921,20 @@ void CPU::exec_op(u8 opcode)
 
 		//JP nn
 		case 0xC3 :
-			reg.pc = mem.read_word(reg.pc);
+			reg.pc = fetch_word(reg.pc);
 			cycles += 12;
 			break;
 
 		//CALL NZ, nn
 		case 0xC4 :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
+				u8 zero_flag = lazy_zero();
 				
 				if(zero_flag == 0) 
 				{
 					reg.sp -= 2;
 					mem.write_word(reg.sp, reg.pc+2);
-					reg.pc = mem.read_word(reg.pc);
+					reg.pc = fetch_word(reg.pc);
 				}
 				
 				else { reg.pc += 2; }
@@ -1831,7 +1951,7 @@ void CPU::exec_op(u8 opcode)
 
 		//ADD A, n
 		case 0xC6 :
-			reg.a = add_byte(reg.a, mem.read_byte(reg.pc++));
+			reg.a = add_byte(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -1846,7 +1966,7 @@ void CPU::exec_op(u8 opcode)
 		//RET Z
 		case 0xC8 :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
+				u8 zero_flag = lazy_zero();
 				if(zero_flag == 1) { reg.pc = mem.read_word(reg.sp); reg.sp += 2;} 
 				cycles += 8;
 			}
@@ -1862,8 +1982,8 @@ void CPU::exec_op(u8 opcode)
 		//JP Z nn
 		case 0xCA :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
-				if(zero_flag == 1) { reg.pc = mem.read_word(reg.pc); }
+				u8 zero_flag = lazy_zero();
+				if(zero_flag == 1) { reg.pc = fetch_word(reg.pc); }
 				else { reg.pc += 2; }
 				cycles += 12;
 			}
@@ -1872,20 +1992,20 @@ void CPU::exec_op(u8 opcode)
 		//EXT OPS
 		case 0xCB :
 			temp_word = 0xCB00;
-			temp_word |= mem.read_byte(reg.pc++);
+			temp_word |= fetch_byte(reg.pc++);
 			exec_op(temp_word);
 			break;
 
 		//CALL Z, nn
 		case 0xCC :
 			{
-				u8 zero_flag = (reg.f & 0x80) ? 1 : 0;
+				u8 zero_flag = lazy_zero();
 				
 				if(zero_flag == 1) 
 				{
 					reg.sp -= 2;
 					mem.write_word(reg.sp, reg.pc+2);
-					reg.pc = mem.read_word(reg.pc);
+					reg.pc = fetch_word(reg.pc);
 				}
 				
 				else { reg.pc += 2; }
@@ -1897,13 +2017,13 @@ void CPU::exec_op(u8 opcode)
 		case 0xCD :
 			reg.sp -= 2;
 			mem.write_word(reg.sp, reg.pc+2);
-			reg.pc = mem.read_word(reg.pc);
+			reg.pc = fetch_word(reg.pc);
 			cycles += 12;
 			break;
 
 		//ADC A, n
 		case 0xCE :
-			reg.a = add_carry(reg.a, mem.read_byte(reg.pc++));
+			reg.a = add_carry(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -1918,7 +2038,7 @@ void CPU::exec_op(u8 opcode)
 		//RET NC
 		case 0xD0 :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+				u8 carry_flag = lazy_carry();
 				if(carry_flag == 0) { reg.pc = mem.read_word(reg.sp); reg.sp += 2; }
 				cycles += 8;
 			}
@@ -1934,8 +2054,8 @@ void CPU::exec_op(u8 opcode)
 		//JP NC nn
 		case 0xD2 :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-				if(carry_flag == 0) { reg.pc = mem.read_word(reg.pc); }
+				u8 carry_flag = lazy_carry();
+				if(carry_flag == 0) { reg.pc = fetch_word(reg.pc); }
 				else { reg.pc += 2; }
 				cycles += 12; 
 			}
@@ -1944,13 +2064,13 @@ void CPU::exec_op(u8 opcode)
 		//CALL NC nn
 		case 0xD4 :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+				u8 carry_flag = lazy_carry();
 				
 				if(carry_flag == 0) 
 				{
 					reg.sp -= 2;
 					mem.write_word(reg.sp, reg.pc+2);
-					reg.pc = mem.read_word(reg.pc);
+					reg.pc = fetch_word(reg.pc);
 				}
 				
 				else { reg.pc += 2; }
@@ -1967,7 +2087,7 @@ void CPU::exec_op(u8 opcode)
 
 		//SUB A, n
 		case 0xD6 :
-			reg.a = sub_byte(reg.a, mem.read_byte(reg.pc++));
+			reg.a = sub_byte(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -1982,7 +2102,7 @@ void CPU::exec_op(u8 opcode)
 		//RET C
 		case 0xD8 :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+				u8 carry_flag = lazy_carry();
 				if(carry_flag == 1) { reg.pc = mem.read_word(reg.sp); reg.sp += 2;} 
 				cycles += 8;
 			}
@@ -1999,8 +2119,8 @@ void CPU::exec_op(u8 opcode)
 		//JP C nn
 		case 0xDA :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
-				if(carry_flag == 1) { reg.pc = mem.read_word(reg.pc); }
+				u8 carry_flag = lazy_carry();
+				if(carry_flag == 1) { reg.pc = fetch_word(reg.pc); }
 				else { reg.pc += 2; }
 				cycles += 12;
 			}
@@ -2009,13 +2129,13 @@ void CPU::exec_op(u8 opcode)
 		//CALL C, nn
 		case 0xDC :
 			{
-				u8 carry_flag = (reg.f & 0x10) ? 1 : 0;
+				u8 carry_flag = lazy_carry();
 				
 				if(carry_flag == 1) 
 				{
 					reg.sp -= 2;
 					mem.write_word(reg.sp, reg.pc+2);
-					reg.pc = mem.read_word(reg.pc);
+					reg.pc = fetch_word(reg.pc);
 				}
 				
 				else { reg.pc += 2; }
@@ -2025,7 +2145,7 @@ void CPU::exec_op(u8 opcode)
 
 		//SBC A, n
 		case 0xDE :
-			reg.a = sub_carry(reg.a, mem.read_byte(reg.pc++));
+			reg.a = sub_carry(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -2039,7 +2159,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LDH n, A
 		case 0xE0 :
-			temp_word = (mem.read_byte(reg.pc++) | 0xFF00);
+			temp_word = (fetch_byte(reg.pc++) | 0xFF00);
 			mem.write_byte(temp_word, reg.a);
 			cycles += 12;
 			break;
@@ -2067,7 +2187,7 @@ void CPU::exec_op(u8 opcode)
 
 		//AND n
 		case 0xE6 :
-			reg.a = and_byte(reg.a, mem.read_byte(reg.pc++));
+			reg.a = and_byte(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -2081,7 +2201,7 @@ void CPU::exec_op(u8 opcode)
 
 		//ADD SP, n
 		case 0xE8 :
-			reg.sp = add_signed_byte(reg.sp, mem.read_signed_byte(reg.pc++));
+			reg.sp = add_signed_byte(reg.sp, fetch_byte(reg.pc++));
 			cycles += 16;
 			break;
 
@@ -2093,14 +2213,14 @@ void CPU::exec_op(u8 opcode)
 
 		//LD nn, A
 		case 0xEA :
-			mem.write_byte(mem.read_word(reg.pc), reg.a);
+			mem.write_byte(fetch_word(reg.pc), reg.a);
 			reg.pc += 2;
 			cycles += 16;
 			break;
 
 		//XOR n
 		case 0xEE :
-			reg.a = xor_byte(reg.a, mem.read_byte(reg.pc++));
+			reg.a = xor_byte(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -2114,13 +2234,14 @@ void CPU::exec_op(u8 opcode)
 
 		//LDH A, n
 		case 0xF0 :
-			temp_word = (mem.read_byte(reg.pc++) | 0xFF00);
+			temp_word = (fetch_byte(reg.pc++) | 0xFF00);
 			reg.a = mem.read_byte(temp_word);
 			cycles += 12;
 			break;
 
 		//POP AF
 		case 0xF1 :
+			flag_op = LAZY_NONE;
 			reg.f = mem.read_byte(reg.sp++) & 0xF0;
 			reg.a = mem.read_byte(reg.sp++);
 			cycles += 12;
@@ -2140,6 +2261,7 @@ void CPU::exec_op(u8 opcode)
 
 		//PUSH AF
 		case 0xF5 :
+			sync_flags();
 			mem.write_byte(--reg.sp, reg.a);
 			mem.write_byte(--reg.sp, reg.f);
 			cycles += 16;
@@ -2147,7 +2269,7 @@ void CPU::exec_op(u8 opcode)
 
 		//OR n
 		case 0xF6 :
-			reg.a = or_byte(reg.a, mem.read_byte(reg.pc++));
+			reg.a = or_byte(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
@@ -2161,7 +2283,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LDHL SP, n
 		case 0xF8 :
-			reg.hl = add_signed_byte(reg.sp, mem.read_signed_byte(reg.pc++)); 
+			reg.hl = add_signed_byte(reg.sp, fetch_byte(reg.pc++)); 
 			cycles += 12;
 			break;
 
@@ -2173,7 +2295,7 @@ void CPU::exec_op(u8 opcode)
 
 		//LD A, nn
 		case 0xFA :
-			reg.a = mem.read_byte(mem.read_word(reg.pc));
+			reg.a = mem.read_byte(fetch_word(reg.pc));
 			reg.pc+=2;
 			cycles += 16;
 			break;
@@ -2186,7 +2308,7 @@ void CPU::exec_op(u8 opcode)
 
 		//CP n
 		case 0xFE : 
-			sub_byte(reg.a, mem.read_byte(reg.pc++));
+			sub_byte(reg.a, fetch_byte(reg.pc++));
 			cycles += 8;
 			break;
 
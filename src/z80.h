@@ -13,10 +13,18 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 
 #include "common.h"
 #include "mmu.h"
 
+//Maximum number of instructions decoded into a single block
+const u8 MAX_BLOCK_OPS = 32;
+
+//Instruction lengths and block-ending instructions, used by the block cache and JIT
+extern const u8 op_length[0x100];
+extern const u8 op_ends_block[0x100];
+
 class CPU
 {
 	public:
@@ -78,10 +86,6 @@ class CPU
 	int cpu_clock_m, cpu_clock_t;
 	int cycles;
 
-	//DIV and TIMA timer counters
-	int div_counter, tima_counter;
-	int tima_speed;
-
 	//Memory management unit
 	MMU mem;
 
@@ -95,6 +99,66 @@ class CPU
 	bool pause;
 	bool double_speed;
 
+	//Lazy flag evaluation - Last flag-setting operation, F is only calculated when read
+	enum lazy_flag_op{ LAZY_NONE, LAZY_ADD, LAZY_SUB, LAZY_INC, LAZY_DEC, LAZY_AND, LAZY_LOGIC };
+	lazy_flag_op flag_op;
+	u8 flag_one, flag_two;
+	u16 flag_result;
+	u8 flag_carry;
+
+	//Decoded instruction - Opcode plus any immediate data
+	struct cached_op
+	{
+		u16 pc;
+		u16 operand;
+		u8 opcode;
+		u8 length;
+	};
+
+	//Straight-line run of decoded instructions
+	struct cached_block
+	{
+		u16 start_pc;
+		u16 end_pc;
+		u32 bank;
+		u8 op_count;
+		cached_op ops[MAX_BLOCK_OPS];
+
+		//Next block starting at the same PC in another bank - -1 at the end of the chain
+		s32 next_block;
+
+		//Native code for the leading instructions of the block, if any, and how many times in a row it stopped on the first one
+		u8* native_code;
+		u8 native_bails;
+
+		//Cycles per pass if the block is an idle loop polling LY, STAT, IF, or DIV - 0 otherwise
+		u8 idle_cycles;
+	};
+
+	//Decoded block cache, keyed by PC - Each PC holds a chain of blocks, one per bank, most recently used first
+	std::vector<cached_block> block_pool;
+	std::vector<s32> free_blocks;
+	std::vector<s32> block_lookup;
+	s32 current_block;
+	u8 current_op;
+
+	//Idle loop skipping - Block and start cycle of the last pass through an idle loop, plus totals for reporting
+	s32 idle_block;
+	u64 idle_start;
+	u64 idle_loops;
+	u64 idle_cycles_skipped;
+
+	//Immediate data for the instruction being executed from the block cache
+	bool use_operand;
+	u16 operand;
+
+	//x86-64 recompiler
+	u8* jit_buffer;
+	u32 jit_buffer_size;
+	u32 jit_buffer_pos;
+	bool jit_enabled;
+	bool jit_flush;
+
 	//Core Functions
 	CPU();
 	~CPU();
@@ -103,11 +167,38 @@ class CPU
 	void exec_op(u8 opcode);
 	void exec_op(u16 opcode);
 
+	//Save states
+	void save_state(std::vector<u8> &state);
+	bool load_state(const std::vector<u8> &state, u32 &offset);
+
+	//Block cache
+	void exec_cached_op();
+	s32 find_block(u16 pc);
+	s32 decode_block(u16 pc, u32 bank);
+	u32 block_bank(u16 pc);
+	void invalidate_blocks();
+	void flush_blocks();
+	u8 idle_loop_cycles(cached_block &block);
+	void skip_idle_loop(cached_block &block);
+
+	//x86-64 recompiler
+	bool jit_init();
+	void jit_compile(cached_block &block);
+	void jit_exec(cached_block &block);
+
+	inline u8 fetch_byte(u16 address);
+	inline u16 fetch_word(u16 address);
+
 	//Interrupt handling
 	bool handle_interrupts();
 
 	inline void jr(u8 reg_one);
 
+	//Lazy flags
+	void sync_flags();
+	inline u8 lazy_zero();
+	inline u8 lazy_carry();
+
 	//Math functions
 	inline u8 add_byte(u8 reg_one, u8 reg_two);
 	inline u16 add_word(u16 reg_one, u16 reg_two);
@@ -0,0 +1,377 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : z80_cache.cpp
+// Date : October 17, 2026
+// Description : Game Boy Z80 CPU decoded-block cache
+//
+// Predecodes straight-line runs of code (opcodes + immediate data) into blocks
+// Blocks are keyed by PC and tagged with the bank mapped there
+// Blocks in RAM are invalidated whenever that code is written to
+
+#include "z80.h"
+#include "bench.h"
+#include "scheduler.h"
+
+//Instruction lengths, as executed by CPU::exec_op
+extern const u8 op_length[0x100] = 
+{
+	1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1,
+	1, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+	2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+	2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1,
+	1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 1, 2, 1,
+	2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1,
+	2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1
+};
+
+//Instructions that end a block - Jumps, calls, returns, RSTs, HALT, STOP, and unknown opcodes
+extern const u8 op_ends_block[0x100] = 
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1, 0, 1,
+	1, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1,
+	0, 0, 0, 1, 1, 0, 0, 1, 0, 1, 0, 1, 1, 1, 0, 1,
+	0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 1
+};
+
+/****** Execute the next instruction using the block cache ******/
+void CPU::exec_cached_op()
+{
+	bench_scope timer(bench::CPU_EXEC);
+
+	//Start over once the JIT runs out of room for native code
+	if(jit_flush) { flush_blocks(); }
+
+	//Drop the current block after bank switches or writes to cached code
+	if(mem.cpu_update_blocks)
+	{
+		if(mem.cpu_dirty_code) { invalidate_blocks(); }
+		mem.cpu_update_blocks = false;
+		current_block = -1;
+	}
+
+	//Continue through the current block unless the PC has moved elsewhere (jumps, interrupts)
+	if((current_block == -1) || (current_op >= block_pool[current_block].op_count) || (block_pool[current_block].ops[current_op].pc != reg.pc))
+	{
+		current_block = find_block(reg.pc);
+		current_op = 0;
+
+		//Interpret anything that can't be cached
+		if(current_block == -1)
+		{
+			exec_op(mem.read_byte(reg.pc++));
+			return;
+		}
+	}
+
+	//Skip repeated passes through an idle loop
+	if((current_op == 0) && (block_pool[current_block].idle_cycles != 0)) { skip_idle_loop(block_pool[current_block]); }
+
+	//Run native code for the start of the block when the JIT has compiled it
+	//It returns at the next event, or at the first instruction it can't do, which is interpreted from here on
+	if((current_op == 0) && (block_pool[current_block].native_code != NULL))
+	{
+		jit_exec(block_pool[current_block]);
+		if(current_op != 0) { return; }
+	}
+
+	cached_op& op = block_pool[current_block].ops[current_op++];
+
+	reg.pc++;
+	use_operand = true;
+	operand = op.operand;
+	exec_op(op.opcode);
+	use_operand = false;
+}
+
+/****** Find the block starting at PC, decoding it if necessary ******/
+s32 CPU::find_block(u16 pc)
+{
+	u32 bank = block_bank(pc);
+
+	//Uncacheable memory region
+	if(bank == 0xFFFFFFFF) { return -1; }
+
+	//Look for this bank's block, moving it to the front so the next lookup finds it first
+	s32 prev = -1;
+
+	for(s32 index = block_lookup[pc]; index != -1; index = block_pool[index].next_block)
+	{
+		if(block_pool[index].bank == bank)
+		{
+			if(prev != -1)
+			{
+				block_pool[prev].next_block = block_pool[index].next_block;
+				block_pool[index].next_block = block_lookup[pc];
+				block_lookup[pc] = index;
+			}
+
+			return index;
+		}
+
+		prev = index;
+	}
+
+	s32 index = decode_block(pc, bank);
+	if((index != -1) && (jit_enabled)) { jit_compile(block_pool[index]); }
+
+	return index;
+}
+
+/****** Returns the bank tag for code at PC - 0xFFFFFFFF if the code can't be cached ******/
+u32 CPU::block_bank(u16 pc)
+{
+	//BIOS is always interpreted
+	if(mem.in_bios) { return 0xFFFFFFFF; }
+
+	//ROM Bank 0
+	if(pc <= 0x3FFF) { return 0; }
+
+	//Switchable ROM Bank - MBC1 also uses the upper bank bits and banking mode
+	else if(pc <= 0x7FFF)
+	{
+		if(mem.mbc_type == MMU::MBC1) { return (mem.bank_mode << 16) | (mem.bank_bits << 8) | mem.rom_bank; }
+		else if(mem.mbc_type != MMU::ROM_ONLY) { return mem.rom_bank; }
+		else { return 0; }
+	}
+
+	//Internal RAM - GBC uses banking
+	else if((pc >= 0xC000) && (pc <= 0xCFFF)) { return (config::gb_type == 2) ? 0x100 : 0; }
+	else if((pc >= 0xD000) && (pc <= 0xDFFF)) { return (config::gb_type == 2) ? (0x100 | mem.wram_bank) : 0; }
+
+	//ECHO RAM and High RAM
+	else if((pc >= 0xE000) && (pc <= 0xFDFF)) { return 0; }
+	else if((pc >= 0xFF80) && (pc <= 0xFFFE)) { return 0; }
+
+	//VRAM, External RAM, OAM, and I/O are always interpreted
+	return 0xFFFFFFFF;
+}
+
+/****** Decode a new block starting at PC ******/
+s32 CPU::decode_block(u16 pc, u32 bank)
+{
+	//Blocks never cross into another memory region
+	u32 limit = 0;
+
+	if(pc <= 0x3FFF) { limit = 0x4000; }
+	else if(pc <= 0x7FFF) { limit = 0x8000; }
+	else if(pc <= 0xCFFF) { limit = 0xD000; }
+	else if(pc <= 0xDFFF) { limit = 0xE000; }
+	else if(pc <= 0xFDFF) { limit = 0xFE00; }
+	else { limit = 0xFFFF; }
+
+	//Blocks from other banks at this PC stay cached, so always grab a free slot
+	s32 index = -1;
+
+	if(free_blocks.empty())
+	{
+		index = block_pool.size();
+		block_pool.resize(block_pool.size() + 1);
+	}
+
+	else
+	{
+		index = free_blocks.back();
+		free_blocks.pop_back();
+	}
+
+	//A different block in this slot can't continue the last idle loop
+	if(index == idle_block) { idle_block = -1; }
+
+	cached_block& block = block_pool[index];
+	block.start_pc = pc;
+	block.bank = bank;
+	block.op_count = 0;
+	block.native_code = NULL;
+	block.native_bails = 0;
+
+	u32 address = pc;
+
+	while(block.op_count < MAX_BLOCK_OPS)
+	{
+		u8 opcode = mem.read_byte(address);
+		u8 length = op_length[opcode];
+
+		if(address + length > limit) { break; }
+
+		cached_op& op = block.ops[block.op_count++];
+		op.pc = address;
+		op.opcode = opcode;
+		op.length = length;
+
+		if(length == 2) { op.operand = mem.read_byte(address + 1); }
+		else if(length == 3) { op.operand = mem.read_word(address + 1); }
+		else { op.operand = 0; }
+
+		address += length;
+
+		if(op_ends_block[opcode]) { break; }
+	}
+
+	block.end_pc = address;
+
+	//Nothing decodable here (e.g. an instruction straddling two regions)
+	if(block.op_count == 0)
+	{
+		free_blocks.push_back(index);
+		return -1;
+	}
+
+	block.next_block = block_lookup[pc];
+	block_lookup[pc] = index;
+	block.idle_cycles = idle_loop_cycles(block);
+
+	//Mark RAM-resident code so writes to it invalidate this block
+	if(pc >= 0x8000)
+	{
+		for(u32 chunk = (pc >> 6); chunk <= ((address - 1) >> 6); chunk++) { mem.cpu_code_chunk[chunk] = 1; }
+	}
+
+	return index;
+}
+
+/****** Cycles per pass if the block is an idle loop, otherwise 0 ******/
+//An idle loop reads LY, STAT, IF, or DIV into A, tests it, and branches back to its start
+//A pass only changes A and the flags, using values that stay the same until the next event or DIV tick
+u8 CPU::idle_loop_cycles(cached_block &block)
+{
+	if(block.op_count < 2) { return 0; }
+
+	cached_op& load = block.ops[0];
+	cached_op& branch = block.ops[block.op_count - 1];
+	u8 loop_cycles = 0;
+
+	//LDH A, (n) or LD A, (nn) from a polled register
+	u16 address = (load.opcode == 0xF0) ? (0xFF00 | load.operand) : ((load.opcode == 0xFA) ? load.operand : 0);
+	if((address != REG_LY) && (address != REG_STAT) && (address != REG_IF) && (address != REG_DIV)) { return 0; }
+	loop_cycles += (load.opcode == 0xF0) ? 12 : 16;
+
+	//CP n, AND n, or BIT b, A
+	for(int x = 1; x < (block.op_count - 1); x++)
+	{
+		cached_op& op = block.ops[x];
+
+		if((op.opcode == 0xFE) || (op.opcode == 0xE6) || ((op.opcode == 0xCB) && ((op.operand & 0xC7) == 0x47))) { loop_cycles += 8; }
+		else { return 0; }
+	}
+
+	//JR cc or JP cc back to the start
+	if(((branch.opcode & 0xE7) == 0x20) && ((u16)(branch.pc + 2 + (s8)branch.operand) == block.start_pc)) { loop_cycles += 8; }
+	else if(((branch.opcode & 0xE7) == 0xC2) && (branch.operand == block.start_pc)) { loop_cycles += 12; }
+	else { return 0; }
+
+	return loop_cycles;
+}
+
+/****** Skip passes through an idle loop - Once one pass runs without an event, every pass until the next event does the same ******/
+void CPU::skip_idle_loop(cached_block &block)
+{
+	u64 now = scheduler::cycle_count + cycles;
+
+	//DIV changes without an event, so a loop polling it also has to stop before DIV reads differently from the last pass
+	u16 address = (block.ops[0].opcode == 0xF0) ? (0xFF00 | block.ops[0].operand) : block.ops[0].operand;
+	u64 horizon = scheduler::next_event;
+	if((address == REG_DIV) && (mem.timers.next_div_change(idle_start) < horizon)) { horizon = mem.timers.next_div_change(idle_start); }
+
+	//The last pass has to have gone straight around the loop, with nothing stepped since it started
+	if((idle_block == current_block) && ((now - idle_start) == block.idle_cycles) && (scheduler::last_event <= idle_start) && (horizon > now))
+	{
+		//Stop before the pass that reaches the next event
+		u64 wait = horizon - 1 - now;
+		if(wait > scheduler::MAX_SKIP_CYCLES) { wait = scheduler::MAX_SKIP_CYCLES; }
+
+		u32 skipped = (wait / block.idle_cycles) * block.idle_cycles;
+
+		//Skipped cycles go straight onto the cycle count, so the timers see them when the loop reads them next
+		if(skipped != 0)
+		{
+			scheduler::cycle_count += skipped;
+			now += skipped;
+			idle_loops++;
+			idle_cycles_skipped += skipped;
+		}
+	}
+
+	idle_block = current_block;
+	idle_start = now;
+}
+
+/****** Invalidate any blocks covering RAM that was written to ******/
+void CPU::invalidate_blocks()
+{
+	//Only RAM can be written to, which starts at 0x8000
+	for(u32 chunk = 0x200; chunk < 0x400; chunk++)
+	{
+		if(mem.cpu_code_chunk[chunk] != 2) { continue; }
+
+		mem.cpu_code_chunk[chunk] = 0;
+
+		u32 chunk_start = (chunk << 6);
+		u32 chunk_end = chunk_start + 0x40;
+
+		//A block can start up to (MAX_BLOCK_OPS * 3) - 1 bytes before this chunk and still overlap it
+		//Every bank's block at an address goes, since the chunk doesn't say which bank was written
+		for(u32 address = chunk_start - ((MAX_BLOCK_OPS * 3) - 1); address < chunk_end; address++)
+		{
+			s32* link = &block_lookup[address];
+
+			while(*link != -1)
+			{
+				s32 index = *link;
+
+				if(block_pool[index].end_pc > chunk_start)
+				{
+					*link = block_pool[index].next_block;
+					free_blocks.push_back(index);
+					if(index == current_block) { current_block = -1; }
+				}
+
+				else { link = &block_pool[index].next_block; }
+			}
+		}
+	}
+
+	mem.cpu_dirty_code = false;
+}
+
+/****** Clear the entire block cache ******/
+void CPU::flush_blocks()
+{
+	block_pool.clear();
+	free_blocks.clear();
+	block_lookup.assign(0x10000, -1);
+
+	current_block = -1;
+	current_op = 0;
+	idle_block = -1;
+
+	memset(mem.cpu_code_chunk, 0, sizeof(mem.cpu_code_chunk));
+	mem.cpu_dirty_code = false;
+	mem.cpu_update_blocks = false;
+
+	//Native code for the old blocks is no longer reachable
+	jit_buffer_pos = 0;
+	jit_flush = false;
+}
@@ -0,0 +1,1205 @@
+// GB Enhanced Copyright Daniel Baxter 2013
+// Licensed under the GPLv2
+// See LICENSE.txt for full license text
+
+// File : z80_jit.cpp
+// Date : October 17, 2026
+// Description : Game Boy Z80 CPU x86-64 recompiler
+//
+// Translates blocks from the decoded-block cache into native x86-64 code
+// GB registers are pinned in host registers while a block runs
+// Only code in ROM is translated, loads and stores go through the MMU's page tables
+// Anything else (I/O, banking registers, writes to code) is left to the interpreter
+
+#include "z80.h"
+#include "config.h"
+#include "scheduler.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GBE_JIT_X64
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#endif
+
+//Size of the buffer holding native code
+const u32 JIT_BUFFER_SIZE = 0x400000;
+
+//Blocks shorter than this aren't worth the cost of entering native code
+const u8 JIT_MIN_OPS = 3;
+
+//Native code that stops on its first instruction this many times in a row is dropped
+const u8 JIT_MAX_BAILS = 8;
+
+//Native code runs until it has used up the cycles left before the next event
+//Returns the number of instructions run in the upper 16 bits and the cycles they took in the lower 16
+typedef u32 (*jit_block)(CPU::registers* cpu_reg, u32 cycle_budget);
+
+#ifdef GBE_JIT_X64
+
+//Host registers
+enum host_reg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+//Host registers holding GB registers, in opcode order - B, C, D, E, H, L, (HL), A
+//A = R8, F = R9, B = R10, C = R11, D = R12, E = R13, H = R14, L = R15, SP = RBX
+//RBP points to CPU::registers, RDI to the MMU, ESI holds the cycle budget, RAX, RCX, and RDX are scratch
+const u8 HOST_A = R8;
+const u8 HOST_F = R9;
+const u8 HOST_SP = RBX;
+const s8 host_map[8] = { R10, R11, R12, R13, R14, R15, -1, R8 };
+
+//Stands in for a register to make 8-bit operations work on the byte at [RDX] instead
+const u8 MEM_RDX = 0x10;
+
+//Converts x86 flags (from LAHF) into GB Z, H, and C flags
+u8 jit_flag_table[0x100];
+
+//Per-block translation state
+struct jit_context
+{
+	//Offsets into the MMU
+	u32 read_page;
+	u32 write_page;
+	u32 code_chunk;
+	u32 memory_map;
+
+	//DMG Internal RAM writes are mirrored into Echo RAM
+	bool echo_ram;
+
+	//Jumps that leave native code before an instruction, and which instruction
+	std::vector<u32> exits;
+	std::vector<u8> exit_ops;
+	u8 op_index;
+};
+
+/****** Emit bytes ******/
+void emit(std::vector<u8> &code, u8 value) { code.push_back(value); }
+
+void emit_32(std::vector<u8> &code, u32 value)
+{
+	for(int x = 0; x < 4; x++) { code.push_back(value & 0xFF); value >>= 8; }
+}
+
+/****** Emit REX prefix - Always emitted for 8-bit operations ******/
+void emit_rex(std::vector<u8> &code, bool wide, u8 reg, u8 rm, bool force)
+{
+	u8 rex = 0x40 | (wide ? 0x8 : 0) | ((reg & 0x8) ? 0x4 : 0) | ((rm & 0x8) ? 0x1 : 0);
+	if((rex != 0x40) || (force)) { emit(code, rex); }
+}
+
+/****** Emit register-direct ModRM byte - Or [RDX] for MEM_RDX ******/
+void emit_modrm(std::vector<u8> &code, u8 reg, u8 rm)
+{
+	if(rm == MEM_RDX) { emit(code, ((reg & 0x7) << 3) | RDX); }
+	else { emit(code, 0xC0 | ((reg & 0x7) << 3) | (rm & 0x7)); }
+}
+
+/****** MOV r32, r32 ******/
+void emit_mov(std::vector<u8> &code, u8 dest, u8 src)
+{
+	emit_rex(code, false, src, dest, false);
+	emit(code, 0x89);
+	emit_modrm(code, src, dest);
+}
+
+/****** MOV r32, imm32 ******/
+void emit_mov_imm(std::vector<u8> &code, u8 dest, u32 value)
+{
+	emit_rex(code, false, 0, dest, false);
+	emit(code, 0xB8 + (dest & 0x7));
+	emit_32(code, value);
+}
+
+/****** MOV r64, imm64 ******/
+void emit_mov_imm64(std::vector<u8> &code, u8 dest, u64 value)
+{
+	emit_rex(code, true, 0, dest, false);
+	emit(code, 0xB8 + (dest & 0x7));
+	emit_32(code, (value & 0xFFFFFFFF));
+	emit_32(code, (value >> 32));
+}
+
+/****** ALU r32, r32 - ADD, OR, AND, SUB, XOR ******/
+void emit_alu(std::vector<u8> &code, u8 op, u8 dest, u8 src)
+{
+	emit_rex(code, false, src, dest, false);
+	emit(code, op);
+	emit_modrm(code, src, dest);
+}
+
+/****** ALU r32, imm32 - Extension selects ADD, OR, ADC, SBB, AND, SUB, XOR, CMP ******/
+void emit_alu_imm(std::vector<u8> &code, u8 ext, u8 dest, u32 value)
+{
+	emit_rex(code, false, 0, dest, false);
+	emit(code, 0x81);
+	emit_modrm(code, ext, dest);
+	emit_32(code, value);
+}
+
+/****** ALU r8, r8 ******/
+void emit_alu_8(std::vector<u8> &code, u8 op, u8 dest, u8 src)
+{
+	emit_rex(code, false, src, dest, true);
+	emit(code, op);
+	emit_modrm(code, src, dest);
+}
+
+/****** ALU r8, imm8 ******/
+void emit_alu_imm_8(std::vector<u8> &code, u8 ext, u8 dest, u8 value)
+{
+	emit_rex(code, false, 0, dest, true);
+	emit(code, 0x80);
+	emit_modrm(code, ext, dest);
+	emit(code, value);
+}
+
+/****** SHL/SHR r32, imm8 ******/
+void emit_shift(std::vector<u8> &code, u8 ext, u8 dest, u8 amount)
+{
+	emit_rex(code, false, 0, dest, false);
+	emit(code, 0xC1);
+	emit_modrm(code, ext, dest);
+	emit(code, amount);
+}
+
+/****** ROL/ROR/RCL/RCR r8, 1 ******/
+void emit_rotate_8(std::vector<u8> &code, u8 ext, u8 dest)
+{
+	emit_rex(code, false, 0, dest, true);
+	emit(code, 0xD0);
+	emit_modrm(code, ext, dest);
+}
+
+/****** ROL/ROR r8, imm8 ******/
+void emit_rotate_imm_8(std::vector<u8> &code, u8 ext, u8 dest, u8 amount)
+{
+	emit_rex(code, false, 0, dest, true);
+	emit(code, 0xC0);
+	emit_modrm(code, ext, dest);
+	emit(code, amount);
+}
+
+/****** INC/DEC r8 ******/
+void emit_inc_dec_8(std::vector<u8> &code, u8 ext, u8 dest)
+{
+	emit_rex(code, false, 0, dest, true);
+	emit(code, 0xFE);
+	emit_modrm(code, ext, dest);
+}
+
+/****** BT r32, imm8 ******/
+void emit_bt(std::vector<u8> &code, u8 dest, u8 bit)
+{
+	emit_rex(code, false, 0, dest, false);
+	emit(code, 0x0F);
+	emit(code, 0xBA);
+	emit_modrm(code, 4, dest);
+	emit(code, bit);
+}
+
+/****** TEST r32, imm32 ******/
+void emit_test_imm(std::vector<u8> &code, u8 dest, u32 value)
+{
+	emit_rex(code, false, 0, dest, false);
+	emit(code, 0xF7);
+	emit_modrm(code, 0, dest);
+	emit_32(code, value);
+}
+
+/****** TEST r8, imm8 ******/
+void emit_test_imm_8(std::vector<u8> &code, u8 dest, u8 value)
+{
+	emit_rex(code, false, 0, dest, true);
+	emit(code, 0xF6);
+	emit_modrm(code, 0, dest);
+	emit(code, value);
+}
+
+/****** SETcc r8 ******/
+void emit_setcc(std::vector<u8> &code, u8 condition, u8 dest)
+{
+	emit_rex(code, false, 0, dest, true);
+	emit(code, 0x0F);
+	emit(code, 0x90 | condition);
+	emit_modrm(code, 0, dest);
+}
+
+/****** CMOVcc r32, r32 ******/
+void emit_cmov(std::vector<u8> &code, u8 condition, u8 dest, u8 src)
+{
+	emit_rex(code, false, dest, src, false);
+	emit(code, 0x0F);
+	emit(code, 0x40 | condition);
+	emit_modrm(code, dest, src);
+}
+
+/****** MOVZX r32, r8 ******/
+void emit_movzx_8(std::vector<u8> &code, u8 dest, u8 src)
+{
+	emit_rex(code, false, dest, src, true);
+	emit(code, 0x0F);
+	emit(code, 0xB6);
+	emit_modrm(code, dest, src);
+}
+
+/****** MOVZX r32, r16 ******/
+void emit_movzx_16(std::vector<u8> &code, u8 dest, u8 src)
+{
+	emit_rex(code, false, dest, src, false);
+	emit(code, 0x0F);
+	emit(code, 0xB7);
+	emit_modrm(code, dest, src);
+}
+
+/****** MOVZX r32, byte/word [RBP + offset] ******/
+void emit_load(std::vector<u8> &code, u8 dest, u8 offset, bool word)
+{
+	emit_rex(code, false, dest, RBP, false);
+	emit(code, 0x0F);
+	emit(code, word ? 0xB7 : 0xB6);
+	emit(code, 0x40 | ((dest & 0x7) << 3) | RBP);
+	emit(code, offset);
+}
+
+/****** MOV byte/word [RBP + offset], r8/r16 ******/
+void emit_store(std::vector<u8> &code, u8 src, u8 offset, bool word)
+{
+	if(word) { emit(code, 0x66); }
+	emit_rex(code, false, src, RBP, !word);
+	emit(code, word ? 0x89 : 0x88);
+	emit(code, 0x40 | ((src & 0x7) << 3) | RBP);
+	emit(code, offset);
+}
+
+/****** MOVZX r32, byte [RDX + offset] ******/
+void emit_host_load(std::vector<u8> &code, u8 dest, u32 offset)
+{
+	emit_rex(code, false, dest, RDX, false);
+	emit(code, 0x0F);
+	emit(code, 0xB6);
+	emit(code, 0x80 | ((dest & 0x7) << 3) | RDX);
+	emit_32(code, offset);
+}
+
+/****** MOV byte [RDX + offset], r8 ******/
+void emit_host_store(std::vector<u8> &code, u8 src, u32 offset)
+{
+	emit_rex(code, false, src, RDX, true);
+	emit(code, 0x88);
+	emit(code, 0x80 | ((src & 0x7) << 3) | RDX);
+	emit_32(code, offset);
+}
+
+/****** MOV byte [RDX + offset], imm8 ******/
+void emit_host_store_imm(std::vector<u8> &code, u8 value, u32 offset)
+{
+	emit(code, 0xC6);
+	emit(code, 0x80 | RDX);
+	emit_32(code, offset);
+	emit(code, value);
+}
+
+/****** Jcc/JMP rel32 - Returns where the offset goes, so it can be pointed at its target later ******/
+u32 emit_jump(std::vector<u8> &code, s8 condition)
+{
+	if(condition == -1) { emit(code, 0xE9); }
+	else { emit(code, 0x0F); emit(code, 0x80 | condition); }
+
+	emit_32(code, 0);
+	return code.size() - 4;
+}
+
+/****** Point a jump at the given target, or the end of the code ******/
+void patch_jump(std::vector<u8> &code, u32 jump, u32 target)
+{
+	u32 offset = target - (jump + 4);
+	memcpy(&code[jump], &offset, 4);
+}
+
+void patch_jump(std::vector<u8> &code, u32 jump) { patch_jump(code, jump, code.size()); }
+
+/****** Leave native code before the current instruction when the condition holds ******/
+void emit_exit(std::vector<u8> &code, jit_context &context, s8 condition)
+{
+	context.exits.push_back(emit_jump(code, condition));
+	context.exit_ops.push_back(context.op_index);
+}
+
+/****** Point RDX at the GB memory for the address in EAX - Anything other than plain memory leaves native code ******/
+//Words have to stay within one page, and writes within one 64-byte chunk of tracked code
+void emit_host_address(std::vector<u8> &code, jit_context &context, bool write, bool word)
+{
+	if(word)
+	{
+		emit_mov(code, RCX, RAX);
+		emit_alu_imm(code, 0, RCX, 1);
+		emit_test_imm(code, RCX, write ? 0x3F : 0xFF);
+		emit_exit(code, context, 0x4);
+	}
+
+	//Writes to RAM holding decoded code - Echo RAM mirrors Internal RAM, so check both
+	if(write)
+	{
+		//CMP byte [RDI + RCX + code_chunk], 0
+		emit_mov(code, RCX, RAX);
+		emit_shift(code, 5, RCX, 6);
+		emit(code, 0x80); emit(code, 0xBC); emit(code, 0x0F); emit_32(code, context.code_chunk); emit(code, 0x00);
+		emit_exit(code, context, 0x5);
+
+		emit_alu_imm(code, 0, RCX, 0x80);
+		emit_alu_imm(code, 4, RCX, 0x3FF);
+		emit(code, 0x80); emit(code, 0xBC); emit(code, 0x0F); emit_32(code, context.code_chunk); emit(code, 0x00);
+		emit_exit(code, context, 0x5);
+
+		//Only the first byte of a word at 0xDDFE has an Echo RAM mirror
+		if((word) && (context.echo_ram))
+		{
+			emit_alu_imm(code, 7, RAX, 0xDDFE);
+			emit_exit(code, context, 0x4);
+		}
+	}
+
+	//MOV RDX, [RDI + RCX * 8 + page_table] - TEST RDX, RDX
+	emit_mov(code, RCX, RAX);
+	emit_shift(code, 5, RCX, 8);
+	emit(code, 0x48); emit(code, 0x8B); emit(code, 0x94); emit(code, 0xCF); emit_32(code, write ? context.write_page : context.read_page);
+	emit(code, 0x48); emit(code, 0x85); emit(code, 0xD2);
+	u32 high_ram = emit_jump(code, 0x4);
+
+	//LEA RDX, [RDX + RCX]
+	emit_movzx_8(code, RCX, RAX);
+	emit(code, 0x48); emit(code, 0x8D); emit(code, 0x14); emit(code, 0x0A);
+	u32 done = emit_jump(code, -1);
+
+	//High RAM shares its page with I/O registers, so check for it separately - LEA RDX, [RDI + RAX + memory_map]
+	patch_jump(code, high_ram);
+	emit_alu_imm(code, 7, RAX, 0xFF80);
+	emit_exit(code, context, 0x2);
+	emit_alu_imm(code, 7, RAX, word ? 0xFFFD : 0xFFFE);
+	emit_exit(code, context, 0x7);
+	emit(code, 0x48); emit(code, 0x8D); emit(code, 0x94); emit(code, 0x07); emit_32(code, context.memory_map);
+
+	patch_jump(code, done);
+}
+
+/****** Copy a DMG Internal RAM write into Echo RAM - Address in EAX, host pointer in RDX ******/
+void emit_echo_store(std::vector<u8> &code, jit_context &context, bool word)
+{
+	if(!context.echo_ram) { return; }
+
+	emit_alu_imm(code, 7, RAX, word ? 0xDDFE : 0xDDFF);
+	u32 skip = emit_jump(code, 0x3);
+
+	emit_host_load(code, RCX, 0);
+	emit_host_store(code, RCX, 0x2000);
+
+	if(word)
+	{
+		emit_host_load(code, RCX, 1);
+		emit_host_store(code, RCX, 0x2001);
+	}
+
+	patch_jump(code, skip);
+}
+
+/****** PUSH/POP r64 ******/
+void emit_push(std::vector<u8> &code, u8 reg) { if(reg & 0x8) { emit(code, 0x41); } emit(code, 0x50 + (reg & 0x7)); }
+void emit_pop(std::vector<u8> &code, u8 reg) { if(reg & 0x8) { emit(code, 0x41); } emit(code, 0x58 + (reg & 0x7)); }
+
+/****** Convert x86 flags into GB flags - Z, H, C from the last operation, plus N ******/
+void emit_lahf_flags(std::vector<u8> &code, u8 sub_flag)
+{
+	//MOV RCX, table - LAHF - MOVZX EAX, AH - MOVZX R9D, [RCX + RAX]
+	emit_mov_imm64(code, RCX, (u64)jit_flag_table);
+	emit(code, 0x9F);
+	emit(code, 0x0F); emit(code, 0xB6); emit(code, 0xC4);
+	emit(code, 0x44); emit(code, 0x0F); emit(code, 0xB6); emit(code, 0x0C); emit(code, 0x01);
+
+	if(sub_flag) { emit_alu_imm(code, 1, HOST_F, sub_flag); }
+}
+
+/****** Convert x86 Zero flag into GB flags, plus any fixed flags ******/
+void emit_zero_flag(std::vector<u8> &code, u8 fixed_flags)
+{
+	emit_setcc(code, 0x4, RAX);
+	emit_movzx_8(code, HOST_F, RAX);
+	emit_shift(code, 4, HOST_F, 7);
+
+	if(fixed_flags) { emit_alu_imm(code, 1, HOST_F, fixed_flags); }
+}
+
+/****** Convert x86 Carry flag into the GB Carry flag - All other flags cleared ******/
+void emit_carry_flag(std::vector<u8> &code)
+{
+	emit_setcc(code, 0x2, RAX);
+	emit_movzx_8(code, HOST_F, RAX);
+	emit_shift(code, 4, HOST_F, 4);
+}
+
+/****** Combine two GB registers into a 16-bit value ******/
+void emit_pair(std::vector<u8> &code, u8 dest, u8 hi, u8 lo)
+{
+	emit_mov(code, dest, hi);
+	emit_shift(code, 4, dest, 8);
+	emit_alu(code, 0x09, dest, lo);
+}
+
+/****** Split a 16-bit value into two GB registers ******/
+void emit_split(std::vector<u8> &code, u8 src, u8 hi, u8 lo)
+{
+	emit_movzx_8(code, lo, src);
+	emit_shift(code, 5, src, 8);
+	emit_movzx_8(code, hi, src);
+}
+
+/****** ALU A, r - Source can be any host register ******/
+void emit_alu_a(std::vector<u8> &code, u8 op, u8 src)
+{
+	switch(op)
+	{
+		case 0x0: emit_alu_8(code, 0x00, HOST_A, src); emit_lahf_flags(code, 0); break;
+		case 0x1: emit_bt(code, HOST_F, 4); emit_alu_8(code, 0x10, HOST_A, src); emit_lahf_flags(code, 0); break;
+		case 0x2: emit_alu_8(code, 0x28, HOST_A, src); emit_lahf_flags(code, 0x40); break;
+		case 0x3: emit_bt(code, HOST_F, 4); emit_alu_8(code, 0x18, HOST_A, src); emit_lahf_flags(code, 0x40); break;
+		case 0x4: emit_alu_8(code, 0x20, HOST_A, src); emit_zero_flag(code, 0x20); break;
+		case 0x5: emit_alu_8(code, 0x30, HOST_A, src); emit_zero_flag(code, 0); break;
+		case 0x6: emit_alu_8(code, 0x08, HOST_A, src); emit_zero_flag(code, 0); break;
+		case 0x7: emit_alu_8(code, 0x38, HOST_A, src); emit_lahf_flags(code, 0x40); break;
+	}
+}
+
+/****** INC/DEC r8 - Carry is preserved, Half-Carry and Zero come from the x86 flags ******/
+void emit_inc_dec(std::vector<u8> &code, bool dec, u8 dest)
+{
+	emit_inc_dec_8(code, dec ? 1 : 0, dest);
+	emit_mov_imm64(code, RCX, (u64)jit_flag_table);
+	emit(code, 0x9F);
+	emit(code, 0x0F); emit(code, 0xB6); emit(code, 0xC4);
+	emit(code, 0x0F); emit(code, 0xB6); emit(code, 0x04); emit(code, 0x01);
+	emit_alu_imm(code, 4, RAX, 0xA0);
+	emit_alu_imm(code, 4, HOST_F, 0x10);
+	emit_alu(code, 0x09, HOST_F, RAX);
+	if(dec) { emit_alu_imm(code, 1, HOST_F, 0x40); }
+}
+
+/****** CB rotates, shifts, and SWAP - Carry and Zero from the result, everything else cleared ******/
+void emit_cb_shift(std::vector<u8> &code, u8 op, u8 dest)
+{
+	//SWAP
+	if(op == 0x6)
+	{
+		emit_rotate_imm_8(code, 1, dest, 4);
+		emit_test_imm_8(code, dest, 0xFF);
+		emit_zero_flag(code, 0);
+		return;
+	}
+
+	//RLC, RRC, RL, RR, SLA, SRA, SRL - RL and RR rotate through the current Carry
+	const u8 ext[8] = { 0, 1, 2, 3, 4, 7, 0, 5 };
+	if((op == 0x2) || (op == 0x3)) { emit_bt(code, HOST_F, 4); }
+	emit_rotate_8(code, ext[op], dest);
+
+	emit_setcc(code, 0x2, RAX);
+	emit_test_imm_8(code, dest, 0xFF);
+	emit_setcc(code, 0x4, RCX);
+	emit_movzx_8(code, HOST_F, RCX);
+	emit_shift(code, 4, HOST_F, 7);
+	emit_movzx_8(code, RAX, RAX);
+	emit_shift(code, 4, RAX, 4);
+	emit_alu(code, 0x09, HOST_F, RAX);
+}
+
+/****** BIT b, r - Carry is preserved, Half-Carry set ******/
+void emit_cb_bit(std::vector<u8> &code, u8 bit, u8 dest)
+{
+	emit_test_imm_8(code, dest, (1 << bit));
+	emit_setcc(code, 0x4, RAX);
+	emit_movzx_8(code, RAX, RAX);
+	emit_shift(code, 4, RAX, 7);
+	emit_alu_imm(code, 4, HOST_F, 0x10);
+	emit_alu_imm(code, 1, HOST_F, 0x20);
+	emit_alu(code, 0x09, HOST_F, RAX);
+}
+
+/****** Push a 16-bit immediate - Used by CALL and RST ******/
+void emit_push_imm(std::vector<u8> &code, jit_context &context, u16 value)
+{
+	emit_mov(code, RAX, HOST_SP);
+	emit_alu_imm(code, 5, RAX, 2);
+	emit_alu_imm(code, 4, RAX, 0xFFFF);
+	emit_host_address(code, context, true, true);
+	emit_host_store_imm(code, (value & 0xFF), 0);
+	emit_host_store_imm(code, (value >> 8), 1);
+	emit_echo_store(code, context, true);
+	emit_mov(code, HOST_SP, RAX);
+}
+
+/****** Pop a 16-bit value into EAX - Used by RET ******/
+void emit_pop_pc(std::vector<u8> &code, jit_context &context)
+{
+	emit_mov(code, RAX, HOST_SP);
+	emit_host_address(code, context, false, true);
+	emit_host_load(code, RCX, 0);
+	emit_host_load(code, RAX, 1);
+	emit_shift(code, 4, RAX, 8);
+	emit_alu(code, 0x09, RAX, RCX);
+	emit_alu_imm(code, 0, HOST_SP, 2);
+	emit_movzx_16(code, HOST_SP, HOST_SP);
+}
+
+/****** Static addresses that are always I/O registers (or IE) are never translated ******/
+bool jit_io_address(u16 address) { return ((address >= 0xFF00) && ((address < 0xFF80) || (address == 0xFFFF))); }
+
+/****** Translate a single instruction - Returns false if it must be interpreted ******/
+bool jit_translate(std::vector<u8> &code, jit_context &context, CPU::cached_op &op, u32 &cycles)
+{
+	u8 opcode = op.opcode;
+	u16 next_pc = op.pc + op.length;
+
+	//LD r, r
+	if((opcode >= 0x40) && (opcode <= 0x7F))
+	{
+		s8 dest = host_map[(opcode >> 3) & 0x7];
+		s8 src = host_map[opcode & 0x7];
+
+		//HALT
+		if((dest == -1) && (src == -1)) { return false; }
+
+		//LD r, (HL)
+		else if(src == -1)
+		{
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, false, false);
+			emit_host_load(code, dest, 0);
+			cycles += 8;
+		}
+
+		//LD (HL), r
+		else if(dest == -1)
+		{
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, true, false);
+			emit_host_store(code, src, 0);
+			emit_echo_store(code, context, false);
+			cycles += 8;
+		}
+
+		else
+		{
+			emit_mov(code, dest, src);
+			cycles += 4;
+		}
+
+		return true;
+	}
+
+	//ALU A, r and ALU A, (HL)
+	if((opcode >= 0x80) && (opcode <= 0xBF))
+	{
+		s8 src = host_map[opcode & 0x7];
+
+		if(src == -1)
+		{
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, false, false);
+			emit_host_load(code, RDX, 0);
+			emit_alu_a(code, (opcode >> 3) & 0x7, RDX);
+			cycles += 8;
+		}
+
+		else
+		{
+			emit_alu_a(code, (opcode >> 3) & 0x7, src);
+			cycles += 4;
+		}
+
+		return true;
+	}
+
+	switch(opcode)
+	{
+		//NOP
+		case 0x00:
+			cycles += 4;
+			return true;
+
+		//LD rr, nn
+		case 0x01: case 0x11: case 0x21:
+			{
+				u8 pair = (opcode >> 4) * 2;
+				emit_mov_imm(code, host_map[pair], (op.operand >> 8));
+				emit_mov_imm(code, host_map[pair + 1], (op.operand & 0xFF));
+				cycles += 12;
+			}
+			return true;
+
+		//LD SP, nn
+		case 0x31:
+			emit_mov_imm(code, HOST_SP, op.operand);
+			cycles += 12;
+			return true;
+
+		//INC rr, DEC rr
+		case 0x03: case 0x13: case 0x23:
+		case 0x0B: case 0x1B: case 0x2B:
+			{
+				u8 pair = (opcode >> 4) * 2;
+				emit_pair(code, RAX, host_map[pair], host_map[pair + 1]);
+				emit_alu_imm(code, (opcode & 0x8) ? 5 : 0, RAX, 1);
+				emit_split(code, RAX, host_map[pair], host_map[pair + 1]);
+				cycles += 8;
+			}
+			return true;
+
+		//INC SP, DEC SP
+		case 0x33: case 0x3B:
+			emit_alu_imm(code, (opcode & 0x8) ? 5 : 0, HOST_SP, 1);
+			emit_movzx_16(code, HOST_SP, HOST_SP);
+			cycles += 8;
+			return true;
+
+		//INC r, DEC r
+		case 0x04: case 0x0C: case 0x14: case 0x1C: case 0x24: case 0x2C: case 0x3C:
+		case 0x05: case 0x0D: case 0x15: case 0x1D: case 0x25: case 0x2D: case 0x3D:
+			emit_inc_dec(code, (opcode & 0x1), host_map[(opcode >> 3) & 0x7]);
+			cycles += 4;
+			return true;
+
+		//INC (HL), DEC (HL)
+		case 0x34: case 0x35:
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, true, false);
+			emit_inc_dec(code, (opcode & 0x1), MEM_RDX);
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_echo_store(code, context, false);
+			cycles += 12;
+			return true;
+
+		//LD (HL), n
+		case 0x36:
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, true, false);
+			emit_host_store_imm(code, (op.operand & 0xFF), 0);
+			emit_echo_store(code, context, false);
+			cycles += 12;
+			return true;
+
+		//LD (BC), A and LD (DE), A
+		case 0x02: case 0x12:
+			emit_pair(code, RAX, host_map[(opcode >> 4) * 2], host_map[((opcode >> 4) * 2) + 1]);
+			emit_host_address(code, context, true, false);
+			emit_host_store(code, HOST_A, 0);
+			emit_echo_store(code, context, false);
+			cycles += 8;
+			return true;
+
+		//LD A, (BC) and LD A, (DE)
+		case 0x0A: case 0x1A:
+			emit_pair(code, RAX, host_map[(opcode >> 4) * 2], host_map[((opcode >> 4) * 2) + 1]);
+			emit_host_address(code, context, false, false);
+			emit_host_load(code, HOST_A, 0);
+			cycles += 8;
+			return true;
+
+		//LDI (HL), A and LDD (HL), A
+		case 0x22: case 0x32:
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, true, false);
+			emit_host_store(code, HOST_A, 0);
+			emit_echo_store(code, context, false);
+			emit_alu_imm(code, (opcode == 0x22) ? 0 : 5, RAX, 1);
+			emit_split(code, RAX, host_map[4], host_map[5]);
+			cycles += 8;
+			return true;
+
+		//LDI A, (HL) and LDD A, (HL)
+		case 0x2A: case 0x3A:
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			emit_host_address(code, context, false, false);
+			emit_host_load(code, HOST_A, 0);
+			emit_alu_imm(code, (opcode == 0x2A) ? 0 : 5, RAX, 1);
+			emit_split(code, RAX, host_map[4], host_map[5]);
+			cycles += 8;
+			return true;
+
+		//LD (nn), A and LDH (n), A
+		case 0xEA: case 0xE0:
+			{
+				u16 address = (opcode == 0xE0) ? (0xFF00 | (op.operand & 0xFF)) : op.operand;
+				if((address < 0xC000) || ((address >= 0xE000) && (address < 0xFF80)) || (address == 0xFFFF)) { return false; }
+
+				emit_mov_imm(code, RAX, address);
+				emit_host_address(code, context, true, false);
+				emit_host_store(code, HOST_A, 0);
+				emit_echo_store(code, context, false);
+				cycles += (opcode == 0xE0) ? 12 : 16;
+			}
+			return true;
+
+		//LD A, (nn) and LDH A, (n)
+		case 0xFA: case 0xF0:
+			{
+				u16 address = (opcode == 0xF0) ? (0xFF00 | (op.operand & 0xFF)) : op.operand;
+				if(jit_io_address(address)) { return false; }
+
+				emit_mov_imm(code, RAX, address);
+				emit_host_address(code, context, false, false);
+				emit_host_load(code, HOST_A, 0);
+				cycles += (opcode == 0xF0) ? 12 : 16;
+			}
+			return true;
+
+		//PUSH rr
+		case 0xC5: case 0xD5: case 0xE5: case 0xF5:
+			{
+				u8 pair = ((opcode >> 4) & 0x3) * 2;
+				u8 hi = (opcode == 0xF5) ? HOST_A : host_map[pair];
+				u8 lo = (opcode == 0xF5) ? HOST_F : host_map[pair + 1];
+
+				emit_mov(code, RAX, HOST_SP);
+				emit_alu_imm(code, 5, RAX, 2);
+				emit_alu_imm(code, 4, RAX, 0xFFFF);
+				emit_host_address(code, context, true, true);
+				emit_host_store(code, lo, 0);
+				emit_host_store(code, hi, 1);
+				emit_echo_store(code, context, true);
+				emit_mov(code, HOST_SP, RAX);
+				cycles += 16;
+			}
+			return true;
+
+		//POP rr - The lower bits of F always read 0
+		case 0xC1: case 0xD1: case 0xE1: case 0xF1:
+			{
+				u8 pair = ((opcode >> 4) & 0x3) * 2;
+				u8 hi = (opcode == 0xF1) ? HOST_A : host_map[pair];
+				u8 lo = (opcode == 0xF1) ? HOST_F : host_map[pair + 1];
+
+				emit_mov(code, RAX, HOST_SP);
+				emit_host_address(code, context, false, true);
+				emit_host_load(code, lo, 0);
+				emit_host_load(code, hi, 1);
+				if(opcode == 0xF1) { emit_alu_imm(code, 4, HOST_F, 0xF0); }
+				emit_alu_imm(code, 0, HOST_SP, 2);
+				emit_movzx_16(code, HOST_SP, HOST_SP);
+				cycles += 12;
+			}
+			return true;
+
+		//CB prefixed instructions - The second opcode byte is the operand
+		case 0xCB:
+			{
+				u8 cb_op = (op.operand & 0xFF);
+				u8 group = (cb_op >> 6);
+				u8 bit = (cb_op >> 3) & 0x7;
+				bool memory = ((cb_op & 0x7) == 0x6);
+				u8 dest = memory ? MEM_RDX : host_map[cb_op & 0x7];
+
+				//Instructions on (HL) work on the byte at [RDX] - All except BIT write it back
+				if(memory)
+				{
+					emit_pair(code, RAX, host_map[4], host_map[5]);
+					emit_host_address(code, context, (group != 1), false);
+				}
+
+				switch(group)
+				{
+					case 0x0: emit_cb_shift(code, bit, dest); break;
+					case 0x1: emit_cb_bit(code, bit, dest); break;
+					case 0x2: emit_alu_imm_8(code, 4, dest, u8(~(1 << bit))); break;
+					case 0x3: emit_alu_imm_8(code, 1, dest, (1 << bit)); break;
+				}
+
+				if((memory) && (group != 1))
+				{
+					emit_pair(code, RAX, host_map[4], host_map[5]);
+					emit_echo_store(code, context, false);
+				}
+
+				cycles += ((memory) && (cb_op != 0xAE)) ? 16 : 8;
+			}
+			return true;
+
+		//CALL nn
+		case 0xCD:
+			emit_push_imm(code, context, next_pc);
+			emit_mov_imm(code, RAX, op.operand);
+			cycles += 12;
+			return true;
+
+		//RST n
+		case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+		case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+			emit_push_imm(code, context, next_pc);
+			emit_mov_imm(code, RAX, (opcode & 0x38));
+			cycles += 32;
+			return true;
+
+		//RET
+		case 0xC9:
+			emit_pop_pc(code, context);
+			cycles += 8;
+			return true;
+
+		//CALL cc, nn and RET cc - Skip over the stack access when the condition fails
+		case 0xC4: case 0xCC: case 0xD4: case 0xDC:
+		case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+			{
+				u8 flag = (opcode & 0x10) ? 0x10 : 0x80;
+				bool flag_set = (opcode & 0x08);
+
+				emit_test_imm(code, HOST_F, flag);
+				u32 not_taken = emit_jump(code, flag_set ? 0x4 : 0x5);
+
+				if(opcode & 0x4)
+				{
+					emit_push_imm(code, context, next_pc);
+					emit_mov_imm(code, RAX, op.operand);
+					cycles += 12;
+				}
+
+				else
+				{
+					emit_pop_pc(code, context);
+					cycles += 8;
+				}
+
+				u32 done = emit_jump(code, -1);
+				patch_jump(code, not_taken);
+				emit_mov_imm(code, RAX, next_pc);
+				patch_jump(code, done);
+			}
+			return true;
+
+		//LD r, n
+		case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x3E:
+			emit_mov_imm(code, host_map[(opcode >> 3) & 0x7], (op.operand & 0xFF));
+			cycles += 8;
+			return true;
+
+		//RLC A, RRC A, RL A, RR A - Zero is always cleared
+		case 0x07: emit_rotate_8(code, 0, HOST_A); emit_carry_flag(code); cycles += 4; return true;
+		case 0x0F: emit_rotate_8(code, 1, HOST_A); emit_carry_flag(code); cycles += 8; return true;
+		case 0x17: emit_bt(code, HOST_F, 4); emit_rotate_8(code, 2, HOST_A); emit_carry_flag(code); cycles += 8; return true;
+		case 0x1F: emit_bt(code, HOST_F, 4); emit_rotate_8(code, 3, HOST_A); emit_carry_flag(code); cycles += 8; return true;
+
+		//ADD HL, rr - Zero is preserved
+		case 0x09: case 0x19: case 0x29: case 0x39:
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+
+			if(opcode == 0x39) { emit_mov(code, RCX, HOST_SP); }
+			else { emit_pair(code, RCX, host_map[(opcode >> 4) * 2], host_map[((opcode >> 4) * 2) + 1]); }
+
+			//EDX = Sum, EAX = Half-Carry, ECX = Carry
+			emit_mov(code, RDX, RAX);
+			emit_alu(code, 0x01, RDX, RCX);
+			emit_alu(code, 0x31, RAX, RCX);
+			emit_alu(code, 0x31, RAX, RDX);
+			emit_shift(code, 5, RAX, 7);
+			emit_alu_imm(code, 4, RAX, 0x20);
+			emit_mov(code, RCX, RDX);
+			emit_shift(code, 5, RCX, 12);
+			emit_alu_imm(code, 4, RCX, 0x10);
+			emit_alu_imm(code, 4, HOST_F, 0x80);
+			emit_alu(code, 0x09, HOST_F, RAX);
+			emit_alu(code, 0x09, HOST_F, RCX);
+			emit_split(code, RDX, host_map[4], host_map[5]);
+			cycles += 8;
+			return true;
+
+		//CPL
+		case 0x2F:
+			emit_alu_imm(code, 6, HOST_A, 0xFF);
+			emit_alu_imm(code, 1, HOST_F, 0x60);
+			cycles += 4;
+			return true;
+
+		//SCF
+		case 0x37:
+			emit_alu_imm(code, 4, HOST_F, 0x80);
+			emit_alu_imm(code, 1, HOST_F, 0x10);
+			cycles += 4;
+			return true;
+
+		//CCF
+		case 0x3F:
+			emit_alu_imm(code, 4, HOST_F, 0x90);
+			emit_alu_imm(code, 6, HOST_F, 0x10);
+			cycles += 4;
+			return true;
+
+		//ALU A, n
+		case 0xC6: emit_alu_imm_8(code, 0, HOST_A, op.operand); emit_lahf_flags(code, 0); cycles += 8; return true;
+		case 0xCE: emit_bt(code, HOST_F, 4); emit_alu_imm_8(code, 2, HOST_A, op.operand); emit_lahf_flags(code, 0); cycles += 8; return true;
+		case 0xD6: emit_alu_imm_8(code, 5, HOST_A, op.operand); emit_lahf_flags(code, 0x40); cycles += 8; return true;
+		case 0xDE: emit_bt(code, HOST_F, 4); emit_alu_imm_8(code, 3, HOST_A, op.operand); emit_lahf_flags(code, 0x40); cycles += 8; return true;
+		case 0xE6: emit_alu_imm_8(code, 4, HOST_A, op.operand); emit_zero_flag(code, 0x20); cycles += 8; return true;
+		case 0xEE: emit_alu_imm_8(code, 6, HOST_A, op.operand); emit_zero_flag(code, 0); cycles += 8; return true;
+		case 0xF6: emit_alu_imm_8(code, 1, HOST_A, op.operand); emit_zero_flag(code, 0); cycles += 8; return true;
+		case 0xFE: emit_alu_imm_8(code, 7, HOST_A, op.operand); emit_lahf_flags(code, 0x40); cycles += 8; return true;
+
+		//LD SP, HL
+		case 0xF9:
+			emit_pair(code, HOST_SP, host_map[4], host_map[5]);
+			cycles += 8;
+			return true;
+
+		//JR n, JP nn, JP HL - The new PC goes in EAX
+		case 0x18:
+			emit_mov_imm(code, RAX, u16(next_pc + s8(op.operand)));
+			cycles += 8;
+			return true;
+
+		case 0xC3:
+			emit_mov_imm(code, RAX, op.operand);
+			cycles += 12;
+			return true;
+
+		case 0xE9:
+			emit_pair(code, RAX, host_map[4], host_map[5]);
+			cycles += 4;
+			return true;
+
+		//JR cc, n and JP cc, nn - Select the new PC without branching
+		case 0x20: case 0x28: case 0x30: case 0x38:
+		case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+			{
+				u16 target = (opcode & 0x80) ? op.operand : u16(next_pc + s8(op.operand));
+				u8 flag = (opcode & 0x10) ? 0x10 : 0x80;
+				bool flag_set = (opcode & 0x08);
+
+				emit_mov_imm(code, RAX, next_pc);
+				emit_mov_imm(code, RCX, target);
+				emit_test_imm(code, HOST_F, flag);
+				emit_cmov(code, flag_set ? 0x5 : 0x4, RAX, RCX);
+				cycles += (opcode & 0x80) ? 12 : 8;
+			}
+			return true;
+	}
+
+	return false;
+}
+
+#endif
+
+/****** Set up the recompiler ******/
+bool CPU::jit_init()
+{
+	#ifdef GBE_JIT_X64
+
+	#ifdef _WIN32
+	jit_buffer = (u8*)VirtualAlloc(NULL, JIT_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+	#else
+	jit_buffer = (u8*)mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(jit_buffer == MAP_FAILED) { jit_buffer = NULL; }
+	#endif
+
+	if(jit_buffer == NULL)
+	{
+		std::cout<<"JIT : Could not allocate executable memory, using interpreter \n";
+		return false;
+	}
+
+	//LAHF - SF ZF 0 AF 0 PF 1 CF -> GB Z - H C
+	for(int x = 0; x < 0x100; x++)
+	{
+		jit_flag_table[x] = 0;
+		if(x & 0x40) { jit_flag_table[x] |= 0x80; }
+		if(x & 0x10) { jit_flag_table[x] |= 0x20; }
+		if(x & 0x01) { jit_flag_table[x] |= 0x10; }
+	}
+
+	jit_buffer_size = JIT_BUFFER_SIZE;
+	jit_buffer_pos = 0;
+	jit_enabled = true;
+
+	//Drop anything decoded before the JIT was available
+	flush_blocks();
+
+	std::cout<<"JIT : x86-64 recompiler enabled \n";
+	return true;
+
+	#else
+
+	std::cout<<"JIT : Recompiler is only available on x86-64, using interpreter \n";
+	return false;
+
+	#endif
+}
+
+/****** Translate the leading instructions of a block into native code ******/
+void CPU::jit_compile(cached_block &block)
+{
+	block.native_code = NULL;
+	block.native_bails = 0;
+
+	#ifdef GBE_JIT_X64
+
+	//Code in RAM may be self-modifying, leave it to the interpreter
+	if(block.start_pc > 0x7FFF) { return; }
+
+	std::vector<u8> code;
+	u32 cycles = 0;
+	u8 op_count = 0;
+	bool jumped = false;
+
+	//Cycles used before each instruction, for leaving native code early
+	u32 cycles_before[0x100];
+
+	//Offsets into CPU::registers
+	u8* base = (u8*)&reg;
+	u8 offset_a = (u8*)&reg.a - base;
+	u8 offset_f = (u8*)&reg.f - base;
+	u8 offset_b = (u8*)&reg.b - base;
+	u8 offset_c = (u8*)&reg.c - base;
+	u8 offset_d = (u8*)&reg.d - base;
+	u8 offset_e = (u8*)&reg.e - base;
+	u8 offset_h = (u8*)&reg.h - base;
+	u8 offset_l = (u8*)&reg.l - base;
+	u8 offset_pc = (u8*)&reg.pc - base;
+	u8 offset_sp = (u8*)&reg.sp - base;
+
+	//Offsets into the MMU
+	jit_context context;
+	context.read_page = (u8*)&mem.read_page - (u8*)&mem;
+	context.write_page = (u8*)&mem.write_page - (u8*)&mem;
+	context.code_chunk = (u8*)&mem.cpu_code_chunk - (u8*)&mem;
+	context.memory_map = (u8*)&mem.memory_map - (u8*)&mem;
+	context.echo_ram = (config::gb_type != 2);
+	context.op_index = 0;
+
+	//Prologue - Save callee-saved registers, pin GB registers, RDI points to the MMU, ESI is the cycle budget
+	emit_push(code, RBX); emit_push(code, RBP); emit_push(code, RSI); emit_push(code, RDI);
+	emit_push(code, R12); emit_push(code, R13); emit_push(code, R14); emit_push(code, R15);
+
+	#ifdef _WIN32
+	emit(code, 0x48); emit(code, 0x89); emit(code, 0xCD);
+	emit(code, 0x89); emit(code, 0xD6);
+	#else
+	emit(code, 0x48); emit(code, 0x89); emit(code, 0xFD);
+	#endif
+
+	emit_mov_imm64(code, RDI, (u64)&mem);
+
+	emit_load(code, HOST_A, offset_a, false);
+	emit_load(code, HOST_F, offset_f, false);
+	emit_load(code, host_map[0], offset_b, false);
+	emit_load(code, host_map[1], offset_c, false);
+	emit_load(code, host_map[2], offset_d, false);
+	emit_load(code, host_map[3], offset_e, false);
+	emit_load(code, host_map[4], offset_h, false);
+	emit_load(code, host_map[5], offset_l, false);
+	emit_load(code, HOST_SP, offset_sp, true);
+
+	while(op_count < block.op_count)
+	{
+		cached_op &op = block.ops[op_count];
+		u32 code_size = code.size();
+		u32 exit_count = context.exits.size();
+
+		cycles_before[op_count] = cycles;
+		context.op_index = op_count;
+
+		if(!jit_translate(code, context, op, cycles))
+		{
+			code.resize(code_size);
+			context.exits.resize(exit_count);
+			context.exit_ops.resize(exit_count);
+			break;
+		}
+
+		op_count++;
+
+		//Jumps always end a block, and leave the new PC in EAX
+		if(op_ends_block[op.opcode]) { jumped = true; break; }
+
+		//Stop at the next event, same as the interpreter would - CMP ESI, cycles - JBE exit
+		if(op_count < block.op_count)
+		{
+			context.op_index = op_count;
+			emit_alu_imm(code, 7, RSI, cycles);
+			emit_exit(code, context, 0x6);
+		}
+	}
+
+	if(op_count < JIT_MIN_OPS) { return; }
+
+	//Any exit for the instruction that wasn't translated leaves it to the interpreter
+	cycles_before[op_count] = cycles;
+
+	//Otherwise the interpreter picks up at the next instruction
+	if(!jumped) { emit_mov_imm(code, RAX, (op_count < block.op_count) ? block.ops[op_count].pc : block.end_pc); }
+	emit_mov_imm(code, RDX, (op_count << 16) | cycles);
+
+	//Epilogue - Write back GB registers and PC, return instructions and cycles run
+	u32 epilogue = code.size();
+	emit_store(code, HOST_A, offset_a, false);
+	emit_store(code, HOST_F, offset_f, false);
+	emit_store(code, host_map[0], offset_b, false);
+	emit_store(code, host_map[1], offset_c, false);
+	emit_store(code, host_map[2], offset_d, false);
+	emit_store(code, host_map[3], offset_e, false);
+	emit_store(code, host_map[4], offset_h, false);
+	emit_store(code, host_map[5], offset_l, false);
+	emit_store(code, HOST_SP, offset_sp, true);
+	emit_store(code, RAX, offset_pc, true);
+	emit_mov(code, RAX, RDX);
+
+	emit_pop(code, R15); emit_pop(code, R14); emit_pop(code, R13); emit_pop(code, R12);
+	emit_pop(code, RDI); emit_pop(code, RSI); emit_pop(code, RBP); emit_pop(code, RBX);
+	emit(code, 0xC3);
+
+	//Early exits - One stub per instruction, setting the PC and progress before the epilogue
+	std::vector<u32> stubs(op_count + 1, 0);
+
+	for(u32 x = 0; x < context.exits.size(); x++)
+	{
+		u8 index = context.exit_ops[x];
+
+		if(stubs[index] == 0)
+		{
+			stubs[index] = code.size();
+			emit_mov_imm(code, RAX, (index < block.op_count) ? block.ops[index].pc : block.end_pc);
+			emit_mov_imm(code, RDX, (index << 16) | cycles_before[index]);
+			patch_jump(code, emit_jump(code, -1), epilogue);
+		}
+
+		patch_jump(code, context.exits[x], stubs[index]);
+	}
+
+	//When the buffer is full, start over on the next instruction
+	if((jit_buffer_pos + code.size()) > jit_buffer_size)
+	{
+		jit_flush = true;
+		return;
+	}
+
+	memcpy(jit_buffer + jit_buffer_pos, &code[0], code.size());
+	block.native_code = jit_buffer + jit_buffer_pos;
+	jit_buffer_pos += code.size();
+
+	#endif
+}
+
+/****** Run native code for a block ******/
+void CPU::jit_exec(cached_block &block)
+{
+	//Cycles left until the next event
+	u64 now = scheduler::cycle_count + cycles;
+	u32 budget = (scheduler::next_event > now) ? (scheduler::next_event - now) : 0;
+	if(budget > 0xFFFF) { budget = 0xFFFF; }
+
+	//Native code works on a fully calculated F
+	sync_flags();
+	u32 result = ((jit_block)block.native_code)(&reg, budget);
+	cycles += (result & 0xFFFF);
+	current_op = (result >> 16);
+
+	//Blocks that keep stopping on their first instruction (I/O, code in RAM, etc) go back to the interpreter
+	if(current_op != 0) { block.native_bails = 0; }
+	else if(++block.native_bails == JIT_MAX_BAILS) { block.native_code = NULL; }
+}
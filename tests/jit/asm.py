@@ -0,0 +1,96 @@
+# Minimal LR35902 assembler helpers for generating test ROMs
+import random, struct
+
+R8 = {'b':0,'c':1,'d':2,'e':3,'h':4,'l':5,'(hl)':6,'a':7}
+R16 = {'bc':0,'de':1,'hl':2,'sp':3}
+R16S = {'bc':0,'de':1,'hl':2,'af':3}
+CC = {'nz':0,'z':1,'nc':2,'c':3}
+ALU = {'add':0,'adc':1,'sub':2,'sbc':3,'and':4,'xor':5,'or':6,'cp':7}
+
+class Asm:
+    def __init__(self, size=0x8000):
+        self.rom = bytearray(size)
+        self.pc = 0
+        self.labels = {}
+        self.fixups = []  # (pos, label, kind, base)
+    def org(self, a): self.pc = a
+    def label(self, n): self.labels[n] = self.pc
+    def db(self, *bs):
+        for b in bs:
+            self.rom[self.pc] = b & 0xFF; self.pc += 1
+    def dw(self, w): self.db(w & 0xFF, w >> 8)
+    def _addr(self, v):
+        if isinstance(v, str):
+            self.fixups.append((self.pc, v, 'abs', 0)); self.dw(0)
+        else: self.dw(v)
+    def _rel(self, v):
+        if isinstance(v, str):
+            self.fixups.append((self.pc, v, 'rel', self.pc + 1)); self.db(0)
+        else: self.db(v)
+    def link(self):
+        for pos, lab, kind, base in self.fixups:
+            t = self.labels[lab]
+            if kind == 'abs':
+                self.rom[pos] = t & 0xFF; self.rom[pos+1] = t >> 8
+            else:
+                d = t - base
+                assert -128 <= d <= 127, (lab, d)
+                self.rom[pos] = d & 0xFF
+        return self.rom
+    # instructions
+    def nop(self): self.db(0)
+    def ld_r_r(self, d, s): self.db(0x40 | R8[d] << 3 | R8[s])
+    def ld_r_n(self, r, n): self.db(0x06 | R8[r] << 3, n)
+    def ld_rr_nn(self, rr, nn): self.db(0x01 | R16[rr] << 4); self._addr(nn)
+    def ld_a_mem(self, a):
+        if isinstance(a, int) and a >= 0xFF00: self.db(0xF0, a & 0xFF)
+        else: self.db(0xFA); self._addr(a)
+    def ld_mem_a(self, a):
+        if isinstance(a, int) and a >= 0xFF00: self.db(0xE0, a & 0xFF)
+        else: self.db(0xEA); self._addr(a)
+    def ldi_hl_a(self): self.db(0x22)
+    def ldi_a_hl(self): self.db(0x2A)
+    def ldd_hl_a(self): self.db(0x32)
+    def ld_de_a(self): self.db(0x12)
+    def ld_a_de(self): self.db(0x1A)
+    def ld_bc_a(self): self.db(0x02)
+    def ld_a_bc(self): self.db(0x0A)
+    def alu(self, op, r): self.db(0x80 | ALU[op] << 3 | R8[r])
+    def alu_n(self, op, n): self.db(0xC6 | ALU[op] << 3, n)
+    def inc(self, r): self.db(0x04 | R8[r] << 3)
+    def dec(self, r): self.db(0x05 | R8[r] << 3)
+    def inc16(self, rr): self.db(0x03 | R16[rr] << 4)
+    def dec16(self, rr): self.db(0x0B | R16[rr] << 4)
+    def add_hl(self, rr): self.db(0x09 | R16[rr] << 4)
+    def push(self, rr): self.db(0xC5 | R16S[rr] << 4)
+    def pop(self, rr): self.db(0xC1 | R16S[rr] << 4)
+    def jp(self, a, cc=None):
+        self.db(0xC3 if cc is None else 0xC2 | CC[cc] << 3); self._addr(a)
+    def jr(self, a, cc=None):
+        self.db(0x18 if cc is None else 0x20 | CC[cc] << 3); self._rel(a)
+    def call(self, a, cc=None):
+        self.db(0xCD if cc is None else 0xC4 | CC[cc] << 3); self._addr(a)
+    def ret(self, cc=None): self.db(0xC9 if cc is None else 0xC0 | CC[cc] << 3)
+    def reti(self): self.db(0xD9)
+    def ei(self): self.db(0xFB)
+    def di(self): self.db(0xF3)
+    def halt(self): self.db(0x76)
+    def cb(self, op): self.db(0xCB, op)
+    def ldh_c_a(self): self.db(0xE2)
+    def ldh_a_c(self): self.db(0xF2)
+    def stop(self): self.db(0x10, 0x00)
+
+def header(a, cgb=0, mbc=0, romsize=0, ramsize=0):
+    a.org(0x100); a.nop(); a.jp(0x150)
+    a.rom[0x143] = cgb; a.rom[0x147] = mbc; a.rom[0x148] = romsize; a.rom[0x149] = ramsize
+    for i, ch in enumerate(b'GBETEST'): a.rom[0x134 + i] = ch
+
+def lib(a):
+    # memset: hl=dest bc=count e=value ; memcpy: hl=src de=dest bc=count
+    a.label('memset'); a.ld_r_r('a','e'); a.ldi_hl_a(); a.dec16('bc'); a.ld_r_r('a','b'); a.alu('or','c'); a.jr('memset','nz'); a.ret()
+    a.label('memcpy'); a.ldi_a_hl(); a.ld_de_a(); a.inc16('de'); a.dec16('bc'); a.ld_r_r('a','b'); a.alu('or','c'); a.jr('memcpy','nz'); a.ret()
+
+def wait_vblank(a):
+    lab = 'wvb_%d' % a.pc
+    a.label(lab)
+    a.ld_a_mem(0xFF44); a.alu_n('cp', 144); a.jr(lab, 'nz')
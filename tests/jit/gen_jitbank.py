@@ -0,0 +1,61 @@
+import random, sys
+from asm import *
+# MBC1 ROM with a different routine at 0x4000 in every bank, called through a bank switching trampoline
+# Blocks for the same PC in different banks have to stay apart, under a fast timer interrupt
+# usage: gen_jitbank.py <out>
+random.seed(7)
+nbanks = 8
+a = Asm(0x4000 * nbanks)
+header(a, mbc=0x01, romsize=2)
+
+a.org(0x50); a.jp('irq')
+
+a.org(0x200)
+a.label('irq')
+a.push('af'); a.push('hl')
+a.ld_rr_nn('hl', 0xFF81); a.inc('(hl)')
+a.pop('hl'); a.pop('af'); a.reti()
+
+# Select bank A, call its routine at 0x4000, and add what it leaves in A to a checksum for that bank at C100
+a.label('trampoline')
+a.ld_r_r('e', 'a'); a.ld_mem_a(0x2000)
+a.call(0x4000)
+a.ld_r_n('h', 0xC1); a.ld_r_r('l', 'e'); a.alu('add', '(hl)'); a.ld_r_r('(hl)', 'a')
+a.ret()
+
+a.org(0x150); a.jp('start')
+
+a.org(0x800)
+a.label('start')
+a.di()
+a.ld_rr_nn('sp', 0xDFF0)
+a.ld_r_n('a', 0xE9); a.ld_mem_a(0xFF06); a.ld_mem_a(0xFF05)
+a.ld_r_n('a', 0x05); a.ld_mem_a(0xFF07)
+a.ld_r_n('a', 0x00); a.ld_mem_a(0xFF0F)
+a.ld_r_n('a', 0x04); a.ld_mem_a(0xFFFF)
+a.ei()
+
+a.label('main')
+for b in [1, 2, 3, 1, 4, 5, 2, 6, 7, 3, 1, 7]:
+    a.ld_r_n('a', b); a.call('trampoline')
+    a.inc('c')
+a.jp('main')
+
+# Routines - Random register and WRAM work, then a return, at 0x4000 in every bank
+# They are placed by file offset, and only use absolute addresses outside the ROM, so they run fine at 0x4000
+regs = ['a', 'b', 'c', 'd']
+for b in range(1, nbanks):
+    a.org(b * 0x4000)
+    a.ld_rr_nn('hl', 0xC200 + (b * 0x20))
+    for i in range(random.randrange(20, 40)):
+        k = random.randrange(6)
+        r = random.choice(regs)
+        if k == 0: a.alu(random.choice(list(ALU)), r)
+        elif k == 1: a.ld_r_r(r, '(hl)')
+        elif k == 2: a.ld_r_r('(hl)', r)
+        elif k == 3: a.ldi_hl_a()
+        elif k == 4: a.cb((random.randrange(0x100) & 0xF8) | R8[r])
+        else: a.alu_n(random.choice(list(ALU)), random.randrange(256))
+    a.ret()
+
+open(sys.argv[1], 'wb').write(a.link())
@@ -0,0 +1,32 @@
+import sys
+from asm import *
+# VBlank and timer interrupts landing inside a JIT compiled register loop
+# Handlers log their return address and B to a ring buffer at C100-CFFF
+# usage: gen_jitirq.py <out>
+a = Asm(0x8000)
+header(a)
+a.org(0x40); a.jp('log')
+a.org(0x50); a.jp('log')
+a.org(0x150)
+a.di()
+a.ld_rr_nn('sp', 0xFFFE)
+a.ld_r_n('a', 0x00); a.ld_mem_a(0xC000)
+a.ld_r_n('a', 0xC1); a.ld_mem_a(0xC001)
+a.ld_r_n('a', 0x00); a.ld_mem_a(0xFF06)
+a.ld_r_n('a', 0x05); a.ld_mem_a(0xFF07)
+a.ld_r_n('a', 0x00); a.ld_mem_a(0xFF0F)
+a.ld_r_n('a', 0x05); a.ld_mem_a(0xFFFF)
+a.ld_rr_nn('bc', 0); a.ld_r_n('a', 0)
+a.ei()
+a.label('loop')
+a.inc('b'); a.inc('c'); a.alu('add', 'c'); a.jr('loop')
+a.label('log')
+a.push('af'); a.push('de'); a.push('hl')
+a.db(0xF8, 0x06)
+a.ld_r_r('e', '(hl)'); a.inc16('hl'); a.ld_r_r('d', '(hl)')
+a.ld_a_mem(0xC000); a.ld_r_r('l', 'a'); a.ld_a_mem(0xC001); a.ld_r_r('h', 'a')
+a.ld_r_r('(hl)', 'e'); a.inc16('hl'); a.ld_r_r('(hl)', 'd'); a.inc16('hl'); a.ld_r_r('(hl)', 'b'); a.inc16('hl')
+a.ld_r_r('a', 'h'); a.alu_n('cp', 0xD0); a.jr('nowrap', 'nz'); a.ld_r_n('h', 0xC1); a.label('nowrap')
+a.ld_r_r('a', 'l'); a.ld_mem_a(0xC000); a.ld_r_r('a', 'h'); a.ld_mem_a(0xC001)
+a.pop('hl'); a.pop('de'); a.pop('af'); a.reti()
+open(sys.argv[1], 'wb').write(a.link())
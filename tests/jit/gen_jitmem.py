@@ -0,0 +1,140 @@
+import sys, random
+from asm import *
+# Random straight-line code mixing memory, stack, and CB instructions, looped forever under a fast timer interrupt
+# Pointers sit on page, code chunk, bank, and Echo RAM boundaries so native code has to bail out at the right spots
+# usage: gen_jitmem.py <out> <seed> [gbc]
+out = sys.argv[1]
+rng = random.Random(int(sys.argv[2]))
+gbc = len(sys.argv) > 3
+
+a = Asm(0x8000)
+header(a, cgb=0x80 if gbc else 0)
+
+# RST vectors - Short routines that touch A and return
+for v in range(0, 0x40, 8):
+    a.org(v); a.inc('a'); a.alu_n('xor', v | 1); a.ret()
+
+# Every interrupt counts itself in HRAM and returns
+for v in (0x40, 0x48, 0x50, 0x58, 0x60):
+    a.org(v); a.jp('irq')
+
+WRITE_PTRS = [0xC000, 0xC03E, 0xC0FE, 0xCFFE, 0xD000, 0xDDFC, 0xDDFE, 0xDDFF, 0xDFF8, 0xFF80, 0xFFF8]
+READ_PTRS = WRITE_PTRS + [0x0150, 0x3FFE, 0x4000, 0x7FFE, 0x8000, 0x9FFE, 0xE000, 0xFDFE, 0xFF44, 0xFE00]
+SUB_PTRS = [0xC800, 0xC9FE, 0xD7C0, 0xFFD0]
+STACKS = [0xDFF0, 0xC041, 0xDE00, 0xDE01, 0xD001, 0xFFFE, 0xFF90, 0xE100, 0xC100]
+SAFE_R = ['a', 'b', 'c', 'd', 'e']
+
+def rand_op(a, subs):
+    k = rng.randrange(22)
+    r = rng.choice(SAFE_R)
+    if k == 0: a.ld_r_r(r, '(hl)')
+    elif k == 1: a.ld_r_r('(hl)', rng.choice(SAFE_R + ['h', 'l']))
+    elif k == 2: a.alu(rng.choice(list(ALU)), '(hl)')
+    elif k == 3: (a.inc if rng.random() < 0.5 else a.dec)('(hl)')
+    elif k == 4: a.db(0x36, rng.randrange(256))
+    elif k == 5: rng.choice([a.ldi_hl_a, a.ldd_hl_a, a.ldi_a_hl, lambda: a.db(0x3A)])()
+    elif k == 6: a.ld_rr_nn('de', rng.choice(WRITE_PTRS) + rng.randrange(2)); a.ld_de_a()
+    elif k == 7: a.ld_rr_nn('bc', rng.choice(READ_PTRS)); rng.choice([a.ld_a_bc, a.ld_a_de])()
+    elif k == 8: a.ld_mem_a(rng.choice(WRITE_PTRS) + rng.randrange(2))
+    elif k == 9: a.ld_a_mem(rng.choice(READ_PTRS) + rng.randrange(2))
+    elif k == 10: a.cb((rng.randrange(0x100) & 0xF8) | rng.choice([0, 1, 2, 3, 7]))
+    elif k == 11: a.cb((rng.randrange(0x100) & 0xF8) | 6)
+    elif k == 12:
+        p = rng.choice(['bc', 'de', 'af', 'hl'])
+        q = rng.choice(['bc', 'de', 'af']) if p != 'hl' else 'hl'
+        a.push(p); rand_simple(a); a.pop(q)
+        if q == 'af': a.push('af'); a.pop(rng.choice(['bc', 'de']))
+    elif k == 13: a.call(rng.choice(subs))
+    elif k == 14: a.call(rng.choice(subs), rng.choice(list(CC)))
+    elif k == 15: a.db(0xC7 | (rng.randrange(8) << 3))
+    elif k == 16: a.ld_rr_nn('hl', rng.choice(WRITE_PTRS) + rng.randrange(2))
+    elif k == 17: a.ld_r_n(r, rng.randrange(256))
+    elif k == 18: a.alu(rng.choice(list(ALU)), r)
+    elif k == 19: (a.inc if rng.random() < 0.5 else a.dec)(r)
+    elif k == 20: a.alu_n(rng.choice(list(ALU)), rng.randrange(256))
+    else: a.ld_r_r(r, rng.choice(SAFE_R + ['h', 'l']))
+
+def rand_simple(a):
+    for _ in range(rng.randrange(3)):
+        r = rng.choice(SAFE_R)
+        rng.choice([lambda: a.inc(r), lambda: a.alu('xor', r), lambda: a.ld_r_r(r, '(hl)'), lambda: a.cb(0x10 | R8[r])])()
+
+# Subroutines - Random body, a conditional return, then a plain return
+# They write away from every stack, so their own return address stays intact
+a.org(0x200)
+subs = []
+for s in range(8):
+    name = 'sub%d' % s
+    subs.append(name)
+    a.label(name)
+    a.push('hl'); a.ld_rr_nn('hl', rng.choice(SUB_PTRS))
+    for _ in range(rng.randrange(2, 8)):
+        rand_simple(a); a.cb((rng.randrange(0x100) & 0xF8) | 6)
+    a.pop('hl')
+    a.ret(rng.choice(list(CC)))
+    a.inc('b'); a.ret()
+
+a.label('ram_code')
+a.ld_r_n('a', 0x12); a.alu('add', 'b'); a.ld_r_r('b', 'a'); a.inc('c'); a.inc('d'); a.ret()
+lib(a)
+
+assert a.pc < 0x800
+a.label('irq')
+a.push('af'); a.push('hl')
+a.ld_rr_nn('hl', 0xFF81); a.inc('(hl)')
+a.pop('hl'); a.pop('af'); a.reti()
+
+a.org(0x150); a.jp('start')
+
+a.org(0x800)
+a.label('start')
+a.di()
+a.ld_rr_nn('sp', 0xDFF0)
+# Timer at 262144 Hz, reloading every 23 ticks, so interrupts land all over the place
+a.ld_r_n('a', 0xE9); a.ld_mem_a(0xFF06); a.ld_mem_a(0xFF05)
+a.ld_r_n('a', 0x05); a.ld_mem_a(0xFF07)
+a.ld_r_n('a', 0x00); a.ld_mem_a(0xFF0F)
+a.ld_r_n('a', 0x04); a.ld_mem_a(0xFFFF)
+# Code in WRAM at C400, rewritten by the main loop
+a.ld_rr_nn('hl', 'ram_code'); a.ld_rr_nn('de', 0xC400); a.ld_rr_nn('bc', 7); a.call('memcpy')
+a.ld_rr_nn('hl', 'ram_code'); a.ld_rr_nn('de', 0xC440); a.ld_rr_nn('bc', 7); a.call('memcpy')
+a.ld_rr_nn('hl', 0xC000)
+a.ei()
+
+a.label('main')
+a.ld_r_n('a', 0x04); a.ld_mem_a(0xFFFF)
+
+# Fixed edge cases - Self-modifying code through Internal and Echo RAM, words across 0xDDFF, and the low bits of F
+# Results are summed at C600, which nothing else writes - GBC Echo RAM isn't kept in sync here, so call Internal RAM there
+ECHO = 0xC000 if gbc else 0xE000
+def checksum(a, r):
+    a.ld_rr_nn('hl', 0xC600); a.ld_r_r('a', r); a.alu('add', '(hl)'); a.ld_r_r('(hl)', 'a')
+
+a.ld_rr_nn('sp', 0xDFF0)
+a.call(0xC400); a.ld_r_r('a', 'b'); a.ld_mem_a(0xC401); a.call(0xC400)
+a.ld_rr_nn('hl', 0xC401); a.inc('(hl)'); a.inc('c'); a.alu('add', 'c'); a.call(ECHO + 0x400)
+a.ld_rr_nn('hl', 0xC401); a.ld_r_r('(hl)', 'd'); a.inc('e'); a.alu('xor', 'e'); a.call(0xC400)
+checksum(a, 'b')
+a.call(ECHO + 0x440); a.ld_r_r('a', 'b'); a.inc('c'); a.ld_mem_a(0xC441); a.inc('d'); a.call(ECHO + 0x440)
+checksum(a, 'b')
+a.ld_rr_nn('sp', 0xDE00); a.inc('c'); a.push('bc'); a.ld_a_mem(0xFDFE); a.ld_r_r('d', 'a'); a.pop('hl')
+a.ld_rr_nn('sp', 0xDFF0)
+checksum(a, 'd')
+a.ld_r_r('a', 'c'); a.alu_n('or', 0x0F); a.ld_r_r('c', 'a'); a.push('bc'); a.pop('af'); a.push('af'); a.pop('de')
+checksum(a, 'e')
+
+for seg in range(120):
+    if rng.random() < 0.3:
+        a.ld_rr_nn('sp', rng.choice(STACKS))
+    if gbc and rng.random() < 0.2:
+        a.ld_r_n('a', rng.randrange(8)); a.ld_mem_a(0xFF70)
+    a.ld_rr_nn('hl', rng.choice(WRITE_PTRS) + rng.randrange(2))
+    for _ in range(rng.randrange(4, 24)):
+        rand_op(a, subs)
+    if rng.random() < 0.3:
+        a.ld_r_n('a', rng.randrange(256)); a.alu_n('cp', 0x80); a.jr('seg%d' % seg, 'c'); a.inc('c'); a.label('seg%d' % seg)
+a.ld_rr_nn('sp', 0xDFF0)
+a.jp('main')
+
+assert a.pc < 0x8000
+open(out, 'wb').write(a.link())
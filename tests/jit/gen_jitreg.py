@@ -0,0 +1,58 @@
+import random, sys
+from asm import *
+# Register-only code in long straight runs, with each run's registers dumped to a ring buffer at 0x8000-0x8FFF
+# usage: gen_jitreg.py <out>
+random.seed(99)
+a = Asm(0x8000)
+
+header(a)
+a.org(0x200)
+lib(a)
+for cc in CC:
+    a.label('rc_'+cc); a.ret(cc); a.inc('a'); a.ret()
+    a.label('cs_'+cc); a.inc('b'); a.ret()
+a.label('dump')
+a.push('hl'); a.push('de'); a.push('bc'); a.push('af')
+a.db(0xF8, 0x00)  # ld hl, sp+0
+a.ld_a_mem(0xC000); a.ld_r_r('e','a'); a.ld_a_mem(0xC001); a.ld_r_r('d','a')
+a.ld_r_n('b', 8)
+a.label('dump_l'); a.ldi_a_hl(); a.ld_de_a(); a.inc16('de'); a.dec('b'); a.jr('dump_l','nz')
+a.ld_r_r('a','d'); a.alu_n('and', 0x8F); a.ld_r_r('d','a')
+a.ld_r_r('a','e'); a.ld_mem_a(0xC000); a.ld_r_r('a','d'); a.ld_mem_a(0xC001)
+a.db(0xE8, 0x08)  # add sp, 8
+a.ret()
+a.label('maptab')
+for r in range(18):
+    for c in range(32):
+        a.db((r*20+c) & 0xFF if c < 20 else 0)
+a.org(0x150)
+a.jp('start')
+a.org(0x800)
+a.label('start')
+a.di(); a.ld_rr_nn('sp', 0xDFF0)
+a.ld_rr_nn('hl', 'maptab'); a.ld_rr_nn('de', 0x9800); a.ld_rr_nn('bc', 32*18); a.call('memcpy')
+a.ld_r_n('a', 0x00); a.ld_mem_a(0xC000); a.ld_r_n('a', 0x80); a.ld_mem_a(0xC001)
+a.ld_r_n('a', 0xE4); a.ld_mem_a(0xFF47)
+random.seed(99)
+regs = ['a','b','c','d','e','h','l']
+def rop():
+    k = random.random()
+    if k < 0.15: a.ld_r_r(random.choice(regs), random.choice(regs))
+    elif k < 0.22: a.ld_r_n(random.choice(regs), random.randrange(256))
+    elif k < 0.50: a.alu(random.choice(list(ALU)), random.choice(regs))
+    elif k < 0.60: a.alu_n(random.choice(list(ALU)), random.randrange(256))
+    elif k < 0.72: (a.inc if random.random() < .5 else a.dec)(random.choice(regs))
+    elif k < 0.77: (a.inc16 if random.random() < .5 else a.dec16)(random.choice(['bc','de','hl']))
+    elif k < 0.82: a.add_hl(random.choice(['bc','de','hl','sp']))
+    elif k < 0.90: a.db(random.choice([0x2F,0x37,0x3F,0x07,0x0F,0x17,0x1F,0x00]))
+    elif k < 0.95: a.db(0x20 | random.randrange(4) << 3, 1); a.inc(random.choice(regs))
+    else:
+        cc = random.choice(list(CC)); lab = 'j%d' % a.pc
+        a.jp(lab, cc); a.inc('c'); a.label(lab)
+while a.pc < 0x7F00:
+    a.ld_rr_nn('bc', random.randrange(65536)); a.push('bc'); a.pop('af')
+    a.ld_rr_nn('bc', random.randrange(65536)); a.ld_rr_nn('de', random.randrange(65536)); a.ld_rr_nn('hl', random.randrange(65536))
+    for i in range(random.randrange(8, 40)): rop()
+    a.call('dump')
+a.label('end'); a.jr('end')
+open(sys.argv[1], 'wb').write(a.link())
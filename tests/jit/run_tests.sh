@@ -0,0 +1,58 @@
+#!/bin/bash
+# GB Enhanced JIT regression tests
+# Runs each test ROM headless with and without --jit and compares the full save states
+# Any difference in registers, memory, or timing between the interpreter and native code shows up as a mismatch
+#
+# usage: run_tests.sh <path to gbe> [frames] [random seeds]
+# With random seeds, that many extra memory/stack/CB ROMs are generated (needs python3) for both DMG and GBC
+
+gbe=$1
+frames=${2:-60}
+seeds=${3:-0}
+
+if [ -z "$gbe" ] || [ ! -x "$gbe" ]; then
+	echo "usage: $0 <path to gbe> [frames] [random seeds]"
+	exit 2
+fi
+
+dir=$(cd "$(dirname "$0")" && pwd)
+gbe=$(cd "$(dirname "$gbe")" && pwd)/$(basename "$gbe")
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+export PYTHONDONTWRITEBYTECODE=1
+
+roms="$dir/jitreg.gb $dir/jitirq.gb $dir/jitmem.gb $dir/jitmem.gbc $dir/jitbank.gb"
+
+for seed in $(seq 1 $seeds); do
+	python3 "$dir/gen_jitmem.py" "$work/random_$seed.gb" $((seed + 1000)) || exit 2
+	python3 "$dir/gen_jitmem.py" "$work/random_$seed.gbc" $((seed + 1000)) gbc || exit 2
+	roms="$roms $work/random_$seed.gb $work/random_$seed.gbc"
+done
+
+failed=0
+cd "$work"
+
+for rom in $roms; do
+	"$gbe" "$rom" --headless --frames $frames --save_state "$work/interp.state" > "$work/interp.log" 2>&1
+	"$gbe" "$rom" --headless --frames $frames --jit --save_state "$work/jit.state" > "$work/jit.log" 2>&1
+
+	#Both runs must reach the last frame, otherwise the ROM itself is broken
+	if ! grep -q "Ran $frames frames" "$work/interp.log" || ! grep -q "Ran $frames frames" "$work/jit.log"; then
+		echo "FAIL $(basename "$rom") - did not run $frames frames"
+		failed=$((failed + 1))
+
+	elif ! cmp -s "$work/interp.state" "$work/jit.state"; then
+		echo "FAIL $(basename "$rom") - save states differ"
+		failed=$((failed + 1))
+
+	else
+		echo "OK   $(basename "$rom")"
+	fi
+done
+
+if [ $failed -ne 0 ]; then
+	echo "$failed test(s) failed"
+	exit 1
+fi
+
+echo "All tests passed"